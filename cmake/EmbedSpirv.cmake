@@ -0,0 +1,49 @@
+# Turns a SPIR-V binary into a header holding its words as a constexpr array
+#
+# cmake -DSPIRV=<file.spv> -DHEADER=<file.h> -DNAME=<ARRAY_NAME> -P EmbedSpirv.cmake
+
+file(READ ${SPIRV} SPIRV_HEX HEX)
+string(LENGTH "${SPIRV_HEX}" SPIRV_HEX_LENGTH)
+math(EXPR SPIRV_REMAINDER "${SPIRV_HEX_LENGTH} % 8")
+
+if(SPIRV_HEX_LENGTH EQUAL 0 OR NOT SPIRV_REMAINDER EQUAL 0)
+    message(FATAL_ERROR "${SPIRV} is not made of 32-bit words")
+endif()
+
+# SPIR-V is little-endian, so each word's bytes are reversed
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1U;" SPIRV_WORDS "${SPIRV_HEX}")
+
+# Eight words per line
+set(SPIRV_LINES "")
+set(SPIRV_LINE "")
+set(SPIRV_LINE_WORDS 0)
+foreach(WORD ${SPIRV_WORDS})
+    string(APPEND SPIRV_LINE " ${WORD},")
+    math(EXPR SPIRV_LINE_WORDS "${SPIRV_LINE_WORDS} + 1")
+    if(SPIRV_LINE_WORDS EQUAL 8)
+        string(APPEND SPIRV_LINES "         ${SPIRV_LINE}\n")
+        set(SPIRV_LINE "")
+        set(SPIRV_LINE_WORDS 0)
+    endif()
+endforeach()
+
+if(NOT SPIRV_LINE_WORDS EQUAL 0)
+    string(APPEND SPIRV_LINES "         ${SPIRV_LINE}\n")
+endif()
+
+get_filename_component(SOURCE_NAME ${SPIRV} NAME_WLE)
+
+file(WRITE ${HEADER}
+"#pragma once
+
+// Generated from ${SOURCE_NAME} by the Shaders target, don't edit
+
+// std
+#include <cstdint>
+
+namespace VE::Shaders
+{
+    inline constexpr std::uint32_t ${NAME}[]{
+${SPIRV_LINES}    };
+}
+")
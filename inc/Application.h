@@ -2,8 +2,11 @@
 
 #include "Device.h"
 #include "GameObject.h"
+#include "JobSystem.h"
 #include "Model.h"
 #include "Renderer.h"
+#include "Scene.h"
+#include "Settings.h"
 #include "Window.h"
 
 // vulkan headers
@@ -20,14 +23,14 @@ namespace VE
     class Application final
     {
     private:  // Private variables
+        Settings m_settings;
         Window m_window;
         Device m_device;
+        JobSystem m_jobSystem;
         Renderer m_renderer;
-        std::vector<GameObject> m_gameObjects;
+        Scene m_scene;
 
     public:  // Public variables
-        static constexpr std::uint32_t WIDTH{800};
-        static constexpr std::uint32_t HEIGHT{600};
 
     private:  // Private methods
         void loadGameObjects(void);
@@ -43,7 +46,7 @@ namespace VE
         /*------------------------------------------------------------------*/
 
         // Constructor
-        Application(void);
+        Application(const Settings& settings);
 
         // Destructor
         ~Application(void);
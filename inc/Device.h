@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MemoryAllocator.h"
 #include "Window.h"
 
 // Vulkan headers
@@ -7,12 +8,15 @@
 
 // std
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace VE
 {
+    class StagingRing;
+
     struct SwapChainSupportDetails
     {
         VkSurfaceCapabilitiesKHR capabilities;
@@ -24,7 +28,16 @@ namespace VE
     {
         std::optional<std::uint32_t> graphicsFamily;
         std::optional<std::uint32_t> presentFamily;
-        [[nodiscard]] bool isComplete() const { return graphicsFamily.has_value() && presentFamily.has_value(); }
+
+        // Families without graphics, only found on hardware that runs them next to the graphics queue
+        std::optional<std::uint32_t> transferFamily;
+        std::optional<std::uint32_t> computeFamily;
+
+        // Headless devices never present, so they only need a graphics queue
+        [[nodiscard]] bool isComplete(bool needsPresent = true) const
+        {
+            return graphicsFamily.has_value() && (!needsPresent || presentFamily.has_value());
+        }
     };
 
     class Device final
@@ -46,11 +59,28 @@ namespace VE
         VkSurfaceKHR m_surface;
         VkQueue m_graphicsQueue;
         VkQueue m_presentQueue;
+
+        // The graphics queue again when there is no dedicated family for them
+        VkQueue m_transferQueue;
+        VkQueue m_computeQueue;
+        std::uint32_t m_transferFamily;
+        std::uint32_t m_computeFamily;
         const std::vector<const char*> m_validationLayers;
         const std::vector<const char*> m_deviceExtensions;
         VkPhysicalDeviceProperties m_properties;
+        std::unique_ptr<MemoryAllocator> m_allocator;
+        std::unique_ptr<StagingRing> m_stagingRing;
+        VkPipelineCache m_pipelineCache;
+
+        // Value n means frame n has finished on the GPU, frames count from 1
+        VkSemaphore m_frameTimeline;
 
     public:  // Public variables
+        // Relative to the working directory
+        static constexpr const char* PIPELINE_CACHE_PATH{"pipeline_cache.bin"};
+
+        // Timeline semaphores and VkPhysicalDeviceVulkan12Features are core in 1.2
+        static constexpr std::uint32_t MIN_API_VERSION{VK_API_VERSION_1_2};
 
     private:  // Private methods
         void createInstance(void);
@@ -59,6 +89,11 @@ namespace VE
         void pickPhysicalDevice(void);
         void createLogicalDevice(void);
         void createCommandPool(void);
+        void createFrameTimeline(void);
+
+        // Seeded from PIPELINE_CACHE_PATH if it was written by this driver and GPU
+        void createPipelineCache(void);
+        [[nodiscard]] bool isPipelineCacheCompatible(const std::vector<char>& cacheData) const;
 
         /*------------------------------------------------------------------*/
         /*                         Helper Functions                         */
@@ -99,6 +134,12 @@ namespace VE
         VkQueue graphicsQueue(void) { return m_graphicsQueue; }
 
         VkQueue presentQueue(void) { return m_presentQueue; }
+
+        // Work on these may overlap with graphics, resources crossing families need ownership transfers
+        VkQueue transferQueue(void) { return m_transferQueue; }
+        VkQueue computeQueue(void) { return m_computeQueue; }
+        [[nodiscard]] std::uint32_t transferFamily(void) const { return m_transferFamily; }
+        [[nodiscard]] std::uint32_t computeFamily(void) const { return m_computeFamily; }
         SwapChainSupportDetails getSwapChainSupport(void) { return querySwapChainSupport(m_physicalDevice); }
 
         std::uint32_t findMemoryType(std::uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -109,17 +150,21 @@ namespace VE
                                      VkFormatFeatureFlags features);
 
         [[nodiscard]] const VkPhysicalDeviceProperties& getPhysicalDeviceProperties(void) const { return m_properties; }
+        [[nodiscard]] bool isHeadless(void) const { return m_window.isHeadless(); }
+        VkPhysicalDevice physicalDevice(void) { return m_physicalDevice; }
+        VkQueueFamilyProperties getQueueFamilyProperties(std::uint32_t familyIndex);
         /*------------------------------------------------------------------*/
 
         /*------------------------------------------------------------------*/
         /*                     Buffer Helper Functions                      */
 
-        // Buffer Helper Functions
+        // Buffer Helper Functions, memory is sub-allocated from m_allocator
         void createBuffer(std::size_t size,
                           VkBufferUsageFlags usage,
                           VkMemoryPropertyFlags properties,
                           VkBuffer& buffer,
-                          VkDeviceMemory& bufferMemory);
+                          Allocation& bufferAllocation);
+        void destroyBuffer(VkBuffer& buffer, Allocation& bufferAllocation);
         VkCommandBuffer beginSingleTimeCommands(void);
 
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
@@ -130,7 +175,27 @@ namespace VE
         void createImageWithInfo(const VkImageCreateInfo& imageInfo,
                                  VkMemoryPropertyFlags properties,
                                  VkImage& image,
-                                 VkDeviceMemory& imageMemory);
+                                 Allocation& imageAllocation);
+        void destroyImage(VkImage& image, Allocation& imageAllocation);
+
+        MemoryAllocator& allocator(void) { return *m_allocator; }
+
+        // Uploads into device local buffers, batched until the next flush
+        StagingRing& stagingRing(void) { return *m_stagingRing; }
+
+        // Every pipeline is created through it, saved to PIPELINE_CACHE_PATH on destruction
+        VkPipelineCache pipelineCache(void) { return m_pipelineCache; }
+        void savePipelineCache(void);
+        /*------------------------------------------------------------------*/
+
+        /*------------------------------------------------------------------*/
+        /*                      Frame Synchronization                       */
+
+        // Every frame's submission signals its frame number, anything tagged with a frame number can be
+        // released once getCompletedFrame() reached it instead of owning a fence of its own
+        VkSemaphore frameTimeline(void) { return m_frameTimeline; }
+        [[nodiscard]] std::uint64_t getCompletedFrame(void);
+        void waitForFrame(std::uint64_t frameNumber);
         /*------------------------------------------------------------------*/
     };
 }
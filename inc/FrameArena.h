@@ -0,0 +1,60 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace VE
+{
+    // Bump allocator for data that lives exactly one frame, plugged into std::pmr containers.
+    // Allocating is a single atomic add so jobs can share it, deallocating does nothing and reset() drops everything.
+    // A frame that runs out spills to the heap and the next reset() grows the block to fit, after that it's quiet
+    class FrameArena final : public std::pmr::memory_resource
+    {
+    public:  // Public variables
+        static constexpr std::size_t DEFAULT_CAPACITY{1024 * 1024};
+
+    private:  // Private variables
+        std::unique_ptr<std::byte[]> m_block;
+        std::size_t m_capacity;
+        std::atomic<std::size_t> m_used;
+
+        // Allocations that didn't fit into m_block, freed on reset()
+        std::mutex m_overflowMutex;
+        std::vector<std::unique_ptr<std::byte[]>> m_overflowBlocks;
+        std::size_t m_overflowBytes;
+
+    private:  // Private methods
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void* allocateOverflow(std::size_t bytes, std::size_t alignment);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        FrameArena(const FrameArena& copy) = delete;
+        FrameArena& operator=(const FrameArena& copy) = delete;
+        FrameArena(FrameArena&& move) = delete;
+        FrameArena& operator=(FrameArena&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        explicit FrameArena(std::size_t capacity = DEFAULT_CAPACITY);
+
+        // Destructor
+        ~FrameArena(void) override = default;
+
+        // Everything allocated since the last reset is gone, nobody may still hold on to it
+        void reset(void);
+
+        [[nodiscard]] std::size_t getUsed(void) const { return m_used.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::size_t getCapacity(void) const { return m_capacity; }
+    };
+}
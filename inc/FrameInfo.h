@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Camera.h"
+#include "FrameArena.h"
+#include "GpuProfiler.h"
+#include "ParallelCommandRecorder.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+
+namespace VE
+{
+    // Everything a render system needs to record one frame
+    struct FrameInfo
+    {
+        std::uint32_t frameIndex;
+        float frameTime;
+        VkCommandBuffer commandBuffer;
+        const Camera& camera;
+
+        // Set 0 of every pipeline, GlobalUbo of this frame index
+        VkDescriptorSet globalDescriptorSet;
+        GpuProfiler& gpuProfiler;
+
+        // commandBuffer is inside the swap chain render pass, draws go into secondaries from here
+        ParallelCommandRecorder& commandRecorder;
+
+        // Scratch memory that stays valid until this frame index comes around again
+        FrameArena& frameArena;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// std
+#include <chrono>
+
+namespace VE
+{
+    // Holds the loop to a fixed frame rate. Sleeps until shortly before the deadline, the OS wakes us up too late
+    // too often for anything finer, and spins the rest. Deadlines advance by whole periods, so a late frame doesn't
+    // shift every frame after it
+    class FrameLimiter final
+    {
+    private:  // Private variables
+        using Clock = std::chrono::steady_clock;
+
+        Clock::duration m_period;
+        Clock::time_point m_deadline;
+
+    public:  // Public variables
+        // Typical scheduler wake-up latency, the last part of every wait is spun instead of slept
+        static constexpr std::chrono::microseconds SPIN_THRESHOLD{2000};
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        FrameLimiter(const FrameLimiter& copy) = delete;
+        FrameLimiter& operator=(const FrameLimiter& copy) = delete;
+        FrameLimiter(FrameLimiter&& move) = delete;
+        FrameLimiter& operator=(FrameLimiter&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor, 0 frames per second means unlimited and wait() returns right away
+        explicit FrameLimiter(double framesPerSecond);
+
+        // Destructor
+        ~FrameLimiter(void) = default;
+
+        // Blocks until the next frame is due, returns how far past the deadline it woke up in milliseconds
+        double wait(void);
+
+        [[nodiscard]] bool isEnabled(void) const { return m_period != Clock::duration::zero(); }
+    };
+}
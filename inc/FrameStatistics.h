@@ -0,0 +1,63 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace VE
+{
+    enum class ReportFormat
+    {
+        Json,
+        Csv
+    };
+
+    // Everything in milliseconds, variance in milliseconds squared
+    struct FrameTimeSummary
+    {
+        std::size_t count{};
+        double min{};
+        double mean{};
+        double p50{};
+        double p95{};
+        double p99{};
+        double max{};
+        double variance{};
+    };
+
+    class FrameStatistics final
+    {
+    private:  // Private variables
+        std::vector<double> m_samples;
+
+    public:  // Public variables
+
+    private:  // Private methods
+        // Linear interpolation between the closest ranks of sorted samples
+        static double percentile(const std::vector<double>& sorted, double fraction);
+
+    public:  // Public methods
+        // Constructor
+        FrameStatistics(void) = default;
+
+        // Destructor
+        ~FrameStatistics(void) = default;
+
+        void reserve(std::size_t count) { m_samples.reserve(count); }
+        void record(double milliseconds) { m_samples.push_back(milliseconds); }
+        void clear(void) { m_samples.clear(); }
+
+        [[nodiscard]] std::size_t count(void) const { return m_samples.size(); }
+        [[nodiscard]] const std::vector<double>& samples(void) const { return m_samples; }
+        [[nodiscard]] FrameTimeSummary summarize(void) const;
+
+        // Writes one summary per series, JSON also carries the raw samples so stutter can be inspected later
+        static void writeReport(const std::string& filePath,
+                                ReportFormat format,
+                                std::uint64_t warmupFrames,
+                                const std::map<std::string, FrameStatistics>& series);
+    };
+}
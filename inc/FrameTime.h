@@ -8,8 +8,8 @@ namespace VE
     class FrameTime final
     {
     private:  // Private variables
-        std::chrono::system_clock::time_point m_startTime;
-        std::chrono::system_clock::time_point m_gameLoopStartingTime;
+        std::chrono::steady_clock::time_point m_startTime;
+        std::chrono::steady_clock::time_point m_gameLoopStartingTime;
         float m_frameTime;
 
     public:  // Public variables
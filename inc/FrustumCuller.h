@@ -0,0 +1,73 @@
+#pragma once
+
+// glm
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VE
+{
+    struct BoundingSphere
+    {
+        glm::vec3 center{};
+        float radius{};
+    };
+
+    // World space spheres in structure of arrays form, so 4 (SSE) or 8 (AVX) of them load with one instruction
+    struct SphereBatch
+    {
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> radius;
+
+        void clear(void);
+        void resize(std::size_t count);
+        void push(const BoundingSphere& sphere);
+
+        // Lets several threads fill disjoint ranges of a resized batch
+        void set(std::size_t index, const BoundingSphere& sphere);
+        [[nodiscard]] std::size_t size(void) const { return radius.size(); }
+    };
+
+    class FrustumCuller final
+    {
+    public:  // Public variables
+        // left, right, bottom, top, near, far; normalized so plane · point is a distance
+        static constexpr std::size_t PLANE_COUNT{6};
+
+    private:  // Private variables
+        std::array<float, PLANE_COUNT> m_planeX{};
+        std::array<float, PLANE_COUNT> m_planeY{};
+        std::array<float, PLANE_COUNT> m_planeZ{};
+        std::array<float, PLANE_COUNT> m_planeW{};
+
+    public:  // Public methods
+        // Extracts the planes of a [0, 1] depth range projection * view
+        void setViewProjection(const glm::mat4& projectionView);
+
+        // Writes the indices of every sphere that is at least partly inside the frustum to the front of visible and
+        // returns how many there are. Visible needs room for every sphere, so any allocator works for the caller
+        [[nodiscard]] std::size_t cull(const SphereBatch& spheres, std::span<std::uint32_t> visible) const;
+
+        // Same for spheres [first, last) only, room for last - first is enough. Indices are still into the whole batch
+        [[nodiscard]] std::size_t cull(const SphereBatch& spheres,
+                                       std::size_t first,
+                                       std::size_t last,
+                                       std::span<std::uint32_t> visible) const;
+
+        [[nodiscard]] bool isVisible(const BoundingSphere& sphere) const;
+
+        // Plane i as (normal, distance), e.g. for culling the same frustum in a shader
+        [[nodiscard]] glm::vec4 getPlane(std::size_t index) const
+        {
+            return {m_planeX[index], m_planeY[index], m_planeZ[index], m_planeW[index]};
+        }
+    };
+}
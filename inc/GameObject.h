@@ -19,7 +19,7 @@ namespace VE
         glm::vec3 scale{1.0F};
         glm::vec3 rotation{};
 
-        // Make a mat that scale then rotate around z,x,y and then translate
+        // Make a mat that scale then rotate around z,x,y and then translate, in closed form
         [[nodiscard]] glm::mat4 mat4(void) const;
     };
 
@@ -32,12 +32,12 @@ namespace VE
         using id_t = std::uint32_t;
 
         std::shared_ptr<Model> model;
-        glm::vec3 objColor;
+        glm::vec3 objColor;  // multiplied with the vertex colors
         TransformComponent transform;
 
     private:  // Private methods
         // Constructor
-        GameObject(id_t objId) : m_id{objId}, objColor{} {}
+        GameObject(id_t objId) : m_id{objId}, objColor{1.0F} {}
 
     public:  // Public methods
         /*------------------------------------------------------------------*/
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Device.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// glm
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace VE
+{
+    // Set 0 binding 0 of every pipeline, laid out for std140
+    struct GlobalUbo
+    {
+        glm::mat4 projection{1.0F};
+        glm::mat4 view{1.0F};
+        glm::mat4 projectionView{1.0F};
+        float time{};
+        float frameTime{};
+        std::uint32_t frameIndex{};
+    };
+
+    // Camera matrices and frame globals, one persistently mapped uniform buffer and descriptor set per frame in flight
+    class GlobalUniforms final
+    {
+    private:  // Private variables
+        struct FrameUniforms
+        {
+            VkBuffer buffer{VK_NULL_HANDLE};
+            Allocation allocation{};
+            VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        };
+
+        Device& m_device;
+        VkDescriptorSetLayout m_setLayout;
+        VkDescriptorPool m_descriptorPool;
+        std::vector<FrameUniforms> m_frames;
+
+    private:  // Private methods
+        void createSetLayout(void);
+        void createDescriptorPool(void);
+        void createFrameUniforms(void);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        GlobalUniforms(const GlobalUniforms& copy) = delete;
+        GlobalUniforms& operator=(const GlobalUniforms& copy) = delete;
+        GlobalUniforms(GlobalUniforms&& move) = delete;
+        GlobalUniforms& operator=(GlobalUniforms&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        GlobalUniforms(Device& device, std::uint32_t framesInFlight);
+
+        // Destructor
+        ~GlobalUniforms(void);
+
+        // The GPU must be done with this frame index, the buffer is written in place
+        void update(std::uint32_t frameIndex, const GlobalUbo& ubo);
+
+        [[nodiscard]] VkDescriptorSetLayout getSetLayout(void) const { return m_setLayout; }
+        [[nodiscard]] VkDescriptorSet getDescriptorSet(std::uint32_t frameIndex) const
+        {
+            return m_frames[frameIndex].descriptorSet;
+        }
+    };
+}
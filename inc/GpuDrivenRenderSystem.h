@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Device.h"
+#include "FrameInfo.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "Pipeline.h"
+#include "PipelineRegistry.h"
+#include "Scene.h"
+#include "ShaderWatcher.h"
+#include "SwapChain.h"
+
+// vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace VE
+{
+    // Culls on the GPU and draws with indirect commands, the CPU only copies changed objects and resets counters.
+    // Objects are grouped by model, cull.comp bumps the instance count of their group's command and appends
+    // their id to the group's range of the visible list, one indirect draw per group reads it back
+    class GpuDrivenRenderSystem final
+    {
+    private:  // Private variables
+        Device& m_device;
+        JobSystem& m_jobSystem;
+        PipelineRegistry& m_pipelineRegistry;
+
+        VkDescriptorSetLayout m_setLayout;
+        VkDescriptorPool m_descriptorPool;
+        VkPipelineLayout m_cullPipelineLayout;
+        VkPipelineLayout m_pipelineLayout;
+        VkRenderPass m_renderPass;
+        std::shared_ptr<ComputePipeline> m_cullPipeline;
+        std::shared_ptr<Pipeline> m_pipeline;
+
+        // All objects drawn with one model, their visible ids go to [visibleOffset, visibleOffset + objectCount)
+        struct DrawGroup
+        {
+            Model* model{};
+            std::uint32_t objectCount{};
+            std::uint32_t visibleOffset{};
+        };
+        std::vector<DrawGroup> m_groups;
+        std::unordered_map<Model*, std::uint32_t> m_groupIndices;
+
+        // Group of every scene object, NO_GROUP for objects without a model
+        static constexpr std::uint32_t NO_GROUP{std::numeric_limits<std::uint32_t>::max()};
+        std::vector<std::uint32_t> m_objectGroups;
+
+        // Everything the GPU reads or writes during one frame, the frame timeline guards all of it
+        struct FrameResources
+        {
+            VkBuffer objectBuffer{VK_NULL_HANDLE};
+            Allocation objectAllocation{};
+            VkBuffer visibleBuffer{VK_NULL_HANDLE};
+            Allocation visibleAllocation{};
+            std::size_t objectCapacity{};
+
+            VkBuffer commandBuffer{VK_NULL_HANDLE};
+            Allocation commandAllocation{};
+            std::size_t commandCapacity{};
+
+            VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+
+            // Scene version the object buffer holds, objects are only copied again when it changed
+            std::uint64_t uploadedVersion{std::numeric_limits<std::uint64_t>::max()};
+        };
+        std::array<FrameResources, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frames;
+
+        FrustumCuller m_culler;
+
+        // Below this a range isn't worth another job
+        static constexpr std::size_t MIN_OBJECTS_PER_UPLOAD_RANGE{4096};
+
+    private:  // Private methods
+        void createSetLayout(void);
+        void createDescriptorSets(void);
+        void createPipelineLayouts(VkDescriptorSetLayout globalSetLayout);
+
+        // Also called on the shader watcher thread, only read what the constructor set up
+        [[nodiscard]] std::shared_ptr<ComputePipeline> createCullPipeline(
+              std::span<const std::uint32_t> compCode) const;
+        [[nodiscard]] std::shared_ptr<Pipeline> createPipeline(std::span<const std::uint32_t> vertCode,
+                                                               std::span<const std::uint32_t> fragCode) const;
+
+        // Assigns the objects created since the last call to their model's group
+        void updateGroups(const Scene& scene);
+
+        // Only grow, the frame that used this slot last has already finished
+        void reserveObjects(FrameResources& frame, std::size_t objectCount);
+        void reserveCommands(FrameResources& frame, std::size_t groupCount);
+        void writeDescriptorSet(const FrameResources& frame);
+
+        void uploadObjects(FrameResources& frame, const Scene& scene);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        GpuDrivenRenderSystem(const GpuDrivenRenderSystem& copy) = delete;
+        GpuDrivenRenderSystem& operator=(const GpuDrivenRenderSystem& copy) = delete;
+        GpuDrivenRenderSystem(GpuDrivenRenderSystem&& move) = delete;
+        GpuDrivenRenderSystem& operator=(GpuDrivenRenderSystem&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        GpuDrivenRenderSystem(Device& device,
+                              JobSystem& jobSystem,
+                              PipelineRegistry& pipelineRegistry,
+                              VkRenderPass renderPass,
+                              VkDescriptorSetLayout globalSetLayout);
+
+        // Destructor
+        ~GpuDrivenRenderSystem(void);
+
+        // Rebuilds the culling and the drawing pipeline when their shaders change
+        void watchShaders(ShaderWatcher& watcher);
+
+        // Copies changed objects and resets the counters, may replace the buffers of this frame index
+        void update(FrameInfo& frameInfo, const Scene& scene);
+
+        // Records the culling dispatch, must come before the swap chain render pass begins. Writes the draw
+        // commands and visible ids, whoever runs it makes them visible to render()
+        void cull(FrameInfo& frameInfo);
+
+        // Draws what cull() left visible, inside the render pass
+        void render(FrameInfo& frameInfo);
+
+        // Valid until the next update() of the frame index
+        [[nodiscard]] VkBuffer getDrawCommandBuffer(std::uint32_t frameIndex) const
+        {
+            return m_frames[frameIndex].commandBuffer;
+        }
+        [[nodiscard]] VkBuffer getVisibleBuffer(std::uint32_t frameIndex) const
+        {
+            return m_frames[frameIndex].visibleBuffer;
+        }
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Device.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VE
+{
+    struct GpuScopeTiming
+    {
+        std::string name;
+        double milliseconds{};
+    };
+
+    class GpuProfiler final
+    {
+    private:  // Private variables
+        // One query pool per frame in flight, scope i owns queries 2i and 2i + 1
+        struct FrameQueries
+        {
+            VkQueryPool queryPool{VK_NULL_HANDLE};
+            std::vector<std::string> scopeNames;
+            bool recorded{};
+        };
+
+        Device& m_device;
+        std::vector<FrameQueries> m_frames;
+        std::vector<GpuScopeTiming> m_results;
+        std::uint32_t m_maxScopes;
+        std::uint32_t m_currentFrame;
+        std::uint64_t m_timestampMask;
+
+        // Nanoseconds per timestamp tick
+        double m_timestampPeriod;
+        bool m_supported;
+
+    public:  // Public variables
+        // Returned by beginScope() when the scope isn't recorded
+        static constexpr std::uint32_t INVALID_SCOPE{~0U};
+
+    private:  // Private methods
+        void readBack(FrameQueries& frame);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        GpuProfiler(const GpuProfiler& copy) = delete;
+        GpuProfiler& operator=(const GpuProfiler& copy) = delete;
+        GpuProfiler(GpuProfiler&& move) = delete;
+        GpuProfiler& operator=(GpuProfiler&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        GpuProfiler(Device& device, std::uint32_t framesInFlight, std::uint32_t maxScopes = 32);
+
+        // Destructor
+        ~GpuProfiler(void);
+
+        // Must be recorded outside of any render pass, once the frame's previous use has completed.
+        // Collects what this frame slot measured last time around and resets its queries
+        void beginFrame(VkCommandBuffer commandBuffer, std::uint32_t frameIndex);
+
+        std::uint32_t beginScope(VkCommandBuffer commandBuffer,
+                                 const std::string& name,
+                                 VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        void endScope(VkCommandBuffer commandBuffer,
+                      std::uint32_t scope,
+                      VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        // Timings of the most recent frame whose results reached the CPU, in recording order
+        [[nodiscard]] const std::vector<GpuScopeTiming>& getResults(void) const { return m_results; }
+        [[nodiscard]] bool isSupported(void) const { return m_supported; }
+    };
+}
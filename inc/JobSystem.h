@@ -0,0 +1,164 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace VE
+{
+    // Work stealing scheduler, one worker per hardware thread with the thread that created it as worker 0.
+    // Jobs go to the submitting thread's own deque, idle workers steal from the other end of everyone else's.
+    // Only worker threads (the creating thread included) may submit jobs or wait. parallelFor() doesn't allocate,
+    // run() allocates its job and is meant for work outside the frame
+    class JobSystem final
+    {
+    public:  // Public variables
+        using Job = std::function<void(void)>;
+
+        // Tracks a group of jobs, wait() returns once all of them ran and rethrows the first exception
+        struct Counter
+        {
+            std::atomic<std::uint32_t> pending{};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        // Upper bound for the ranges of one parallelFor(), their tasks live on the caller's stack
+        static constexpr std::size_t MAX_RANGES{256};
+
+    private:  // Private variables
+        // Calls function(begin, end). parallelFor() ranges point at the caller's function and live on its stack
+        // until it's done waiting, run() jobs are heap allocated and deleted once they ran
+        struct Task
+        {
+            void (*invoke)(void* function, std::size_t begin, std::size_t end){};
+            void* function{};
+            std::size_t begin{};
+            std::size_t end{};
+            Counter* counter{};
+            bool owned{};
+        };
+
+        // Chase-Lev deque of fixed capacity. The owner pushes and pops at the bottom, thieves take from the top
+        class WorkQueue final
+        {
+        public:  // Public variables
+            static constexpr std::int64_t CAPACITY{4096};
+
+        private:  // Private variables
+            alignas(64) std::atomic<std::int64_t> m_top{};
+            alignas(64) std::atomic<std::int64_t> m_bottom{};
+            std::array<std::atomic<Task*>, CAPACITY> m_tasks{};
+
+        public:  // Public methods
+            // Owner only, false when full
+            bool push(Task* task);
+            Task* pop(void);
+
+            // Any thread
+            Task* steal(void);
+        };
+
+        std::uint32_t m_threadCount;
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+        // Bumped on every submit, sleeping workers wait for it to change
+        std::atomic<std::uint64_t> m_workEpoch{};
+        std::atomic<std::uint32_t> m_sleepingWorkers{};
+        std::atomic<bool> m_stopping{};
+
+        std::vector<std::jthread> m_workers;
+
+    private:  // Private methods
+        void workerLoop(std::uint32_t threadIndex);
+
+        // Queues the task on the calling worker's deque, or runs it right away if that's full
+        void submit(Task* task);
+
+        // Own deque first, then steal round-robin starting after ourselves
+        Task* findTask(std::uint32_t threadIndex);
+        static void execute(Task* task);
+
+        static void pinToCore(std::uint32_t core);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        JobSystem(const JobSystem& copy) = delete;
+        JobSystem& operator=(const JobSystem& copy) = delete;
+        JobSystem(JobSystem&& move) = delete;
+        JobSystem& operator=(JobSystem&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor, 0 threads means one per hardware thread. Pinning puts worker i on core i
+        explicit JobSystem(std::uint32_t threadCount = 0, bool pinThreads = false);
+
+        // Destructor
+        ~JobSystem(void);
+
+        void run(Job job, Counter& counter);
+
+        // Runs other jobs while waiting instead of blocking, so waiting inside a job is fine
+        void wait(Counter& counter);
+
+        // Splits [0, count) into ranges of at least minGrain, calls function(begin, end) for each and waits
+        template<typename Function>
+        void parallelFor(std::size_t count, std::size_t minGrain, Function&& function)
+        {
+            if(count == 0)
+            {
+                return;
+            }
+
+            // A few ranges per thread so stealing can even out uneven ranges
+            const std::size_t rangeCount{
+                  std::min({(count + std::max<std::size_t>(minGrain, 1) - 1) / std::max<std::size_t>(minGrain, 1),
+                            std::size_t{m_threadCount} * 4, MAX_RANGES})};
+
+            using Callable = std::remove_reference_t<Function>;
+
+            // Nothing is allocated per range, wait() doesn't return before every task here has run
+            Counter counter{};
+            std::array<Task, MAX_RANGES> tasks;
+            for(std::size_t range{1}; range < rangeCount; ++range)
+            {
+                Task& task{tasks[range]};
+                task.invoke = [](void* callable, std::size_t begin, std::size_t end)
+                { (*static_cast<Callable*>(callable))(begin, end); };
+                task.function = const_cast<void*>(static_cast<const void*>(std::addressof(function)));
+                task.begin = count * range / rangeCount;
+                task.end = count * (range + 1) / rangeCount;
+                task.counter = &counter;
+                submit(&task);
+            }
+
+            // The calling thread takes the first range instead of just waiting
+            try
+            {
+                function(std::size_t{0}, count / rangeCount);
+            }
+            catch(...)
+            {
+                wait(counter);
+                throw;
+            }
+            wait(counter);
+        }
+
+        [[nodiscard]] std::uint32_t getThreadCount(void) const { return m_threadCount; }
+
+        // Index of the calling worker in [0, getThreadCount()), throws on threads the system doesn't know
+        [[nodiscard]] std::uint32_t getThreadIndex(void) const;
+    };
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VE
+{
+    // Buffers and linear images can't share a bufferImageGranularity page with optimal images,
+    // so each kind is sub-allocated from its own blocks
+    enum class ResourceKind : std::uint32_t
+    {
+        Linear,
+        Optimal
+    };
+
+    struct Allocation
+    {
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+        VkDeviceSize offset{};
+        VkDeviceSize size{};
+
+        // Already offset into the block, only set for host visible memory
+        void* mappedData{};
+
+        std::uint32_t memoryTypeIndex{};
+        ResourceKind kind{ResourceKind::Linear};
+        bool dedicated{};
+    };
+
+    struct MemoryStatistics
+    {
+        std::size_t blockCount{};
+        std::size_t allocationCount{};
+        std::size_t dedicatedAllocationCount{};
+
+        // Device memory objects we own, vkAllocateMemory is limited by maxMemoryAllocationCount
+        std::size_t deviceMemoryCount{};
+
+        VkDeviceSize reservedBytes{};
+        VkDeviceSize usedBytes{};
+        VkDeviceSize dedicatedBytes{};
+
+        // Holes inside the blocks, fragmentation is 1 - largestFreeRange / free bytes
+        std::size_t freeRangeCount{};
+        VkDeviceSize largestFreeRange{};
+        double fragmentation{};
+    };
+
+    class MemoryAllocator final
+    {
+    private:  // Private variables
+        struct Block
+        {
+            VkDeviceMemory memory{VK_NULL_HANDLE};
+            VkDeviceSize size{};
+            VkDeviceSize usedBytes{};
+            std::size_t allocationCount{};
+            void* mappedData{};
+
+            // offset -> size, neighbours are always coalesced
+            std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+        };
+
+        using Pool = std::vector<std::unique_ptr<Block>>;
+
+        VkDevice m_device;
+        VkPhysicalDeviceMemoryProperties m_memoryProperties;
+        std::uint32_t m_maxAllocationCount;
+        std::array<Pool, VK_MAX_MEMORY_TYPES * 2> m_pools;
+        std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> m_blockSizes;
+
+        std::size_t m_deviceMemoryCount;
+        std::size_t m_dedicatedAllocationCount;
+        VkDeviceSize m_dedicatedBytes;
+        std::mutex m_mutex;
+
+    public:  // Public variables
+        static constexpr VkDeviceSize PREFERRED_BLOCK_SIZE{64ULL * 1024 * 1024};
+
+    private:  // Private methods
+        Pool& getPool(std::uint32_t memoryTypeIndex, ResourceKind kind);
+        std::uint32_t findMemoryType(std::uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+        VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, std::uint32_t memoryTypeIndex, void** mappedData);
+        void freeDeviceMemory(VkDeviceMemory memory, bool mapped);
+
+        static bool allocateFromBlock(Block& block, const VkMemoryRequirements& requirements, Allocation& allocation);
+        static void freeToBlock(Block& block, const Allocation& allocation);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        MemoryAllocator(const MemoryAllocator& copy) = delete;
+        MemoryAllocator& operator=(const MemoryAllocator& copy) = delete;
+        MemoryAllocator(MemoryAllocator&& move) = delete;
+        MemoryAllocator& operator=(MemoryAllocator&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+
+        // Destructor
+        ~MemoryAllocator(void);
+
+        // Resources bigger than half a block get their own VkDeviceMemory
+        Allocation allocate(const VkMemoryRequirements& requirements,
+                            VkMemoryPropertyFlags properties,
+                            ResourceKind kind);
+        void free(Allocation& allocation);
+
+        [[nodiscard]] MemoryStatistics getStatistics(void);
+    };
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Device.h"
+#include "JobSystem.h"
+#include "Model.h"
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace VE
+{
+    // Builds Models from .obj files. The first load parses the text and writes "<file>.vemesh" next to it,
+    // later loads map that cache and hand it straight to the staging ring
+    class MeshLoader final
+    {
+    public:  // Public variables
+        // Bump whenever the cache layout or Model::Vertex changes, old caches are then rebuilt
+        static constexpr std::uint32_t CACHE_VERSION{1};
+
+    public:  // Public methods
+        MeshLoader(void) = delete;
+
+        static std::unique_ptr<Model> loadModel(Device& device,
+                                                JobSystem& jobSystem,
+                                                const std::filesystem::path& objPath);
+
+        // Parses or maps every file as its own job, the Models are created on the calling thread
+        static std::vector<std::unique_ptr<Model>> loadModels(Device& device,
+                                                              JobSystem& jobSystem,
+                                                              std::span<const std::filesystem::path> objPaths);
+
+        // Triangulates and welds an .obj file, big files are welded in parallel chunks
+        static Model::Builder parseObj(JobSystem& jobSystem, const std::filesystem::path& objPath);
+
+        static std::filesystem::path getCachePath(const std::filesystem::path& objPath);
+    };
+}
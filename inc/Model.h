@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Device.h"
+#include "FrustumCuller.h"
 
 // Vulkan headers
 #include <vulkan/vulkan.h>
@@ -13,6 +14,7 @@
 
 // std
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace VE
@@ -22,9 +24,18 @@ namespace VE
     private:  // Private variables
         Device& m_device;
         VkBuffer m_vertexBuffer;
-        VkDeviceMemory m_vertexBufferMemory;
+        Allocation m_vertexAllocation;
         std::uint32_t m_vertexCount;
 
+        // Optional, without it we fall back to vkCmdDraw over the vertex list
+        VkBuffer m_indexBuffer;
+        Allocation m_indexAllocation;
+        std::uint32_t m_indexCount;
+        VkIndexType m_indexType;
+
+        // Model space, computed from the vertices on creation
+        BoundingSphere m_boundingSphere;
+
     public:  // Public variables
         struct Vertex
         {
@@ -33,10 +44,26 @@ namespace VE
 
             static std::vector<VkVertexInputBindingDescription> getBindingDescriptions(void);
             static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(void);
+
+            bool operator==(const Vertex& other) const = default;
+        };
+
+        struct Builder
+        {
+            std::vector<Vertex> vertices;
+            std::vector<std::uint32_t> indices;
+
+            // Welds bit-identical vertices of a triangle soup into unique vertices plus indices
+            static Builder weld(const std::vector<Vertex>& triangleSoup);
         };
 
     private:  // Private methods
-        void createVertexBuffers(const std::vector<Vertex>& vertices);
+        void createVertexBuffers(std::span<const Vertex> vertices);
+
+        // Stored as 16-bit whenever every index fits
+        void createIndexBuffers(std::span<const std::uint32_t> indices);
+
+        void destroyBuffers(void);
 
     public:  // Public methods
         /*------------------------------------------------------------------*/
@@ -52,10 +79,24 @@ namespace VE
         // Constructor
         Model(Device& device, const std::vector<Vertex>& vertices);
 
+        // Constructor
+        Model(Device& device, const Builder& builder);
+
+        // Constructor, the data only has to live until the constructor returns (e.g. a mapped mesh cache)
+        Model(Device& device, std::span<const Vertex> vertices, std::span<const std::uint32_t> indices);
+
         // Destructor
         ~Model(void);
 
         void bind(VkCommandBuffer commandBuffer);
-        void draw(VkCommandBuffer commandBuffer);
+
+        [[nodiscard]] const BoundingSphere& getBoundingSphere(void) const { return m_boundingSphere; }
+        void draw(VkCommandBuffer commandBuffer, std::uint32_t instanceCount = 1, std::uint32_t firstInstance = 0);
+
+        // What draw() would do as an indirect command. Non-indexed models fill in a VkDrawIndirectCommand in its first
+        // 16 bytes, either way instanceCount is the second word and the stride is sizeof(VkDrawIndexedIndirectCommand)
+        [[nodiscard]] VkDrawIndexedIndirectCommand getIndirectCommand(std::uint32_t instanceCount,
+                                                                      std::uint32_t firstInstance) const;
+        void drawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset);
     };
 }
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Device.h"
+#include "JobSystem.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VE
+{
+    // Records secondary command buffers for the current render pass as jobs on the job system.
+    // Every worker has its own command pool per frame in flight, reset wholesale in beginFrame()
+    class ParallelCommandRecorder final
+    {
+    private:  // Private variables
+        struct ThreadFrame
+        {
+            VkCommandPool commandPool{VK_NULL_HANDLE};
+            std::vector<VkCommandBuffer> commandBuffers;
+            std::size_t used{};
+        };
+
+        Device& m_device;
+        JobSystem& m_jobSystem;
+        std::uint32_t m_frameIndex;
+
+        // [worker][frame]
+        std::vector<std::vector<ThreadFrame>> m_threadFrames;
+
+        // Inherited by every secondary, set by the renderer when it begins the render pass
+        VkRenderPass m_renderPass;
+        VkFramebuffer m_framebuffer;
+        VkExtent2D m_extent;
+
+        std::vector<VkCommandBuffer> m_recorded;
+
+    private:  // Private methods
+        void createThreadFrames(void);
+
+        // From the calling worker's pool
+        VkCommandBuffer beginSecondary(void);
+        static void endSecondary(VkCommandBuffer commandBuffer);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        ParallelCommandRecorder(const ParallelCommandRecorder& copy) = delete;
+        ParallelCommandRecorder& operator=(const ParallelCommandRecorder& copy) = delete;
+        ParallelCommandRecorder(ParallelCommandRecorder&& move) = delete;
+        ParallelCommandRecorder& operator=(ParallelCommandRecorder&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        ParallelCommandRecorder(Device& device, JobSystem& jobSystem, std::uint32_t framesInFlight);
+
+        // Destructor
+        ~ParallelCommandRecorder(void);
+
+        // The GPU must be done with this frame index, its command pools are reset
+        void beginFrame(std::uint32_t frameIndex);
+        void setRenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent);
+
+        // Records taskCount secondaries in parallel with task(commandBuffer, taskIndex), viewport and scissor are
+        // already set in each of them. Blocks until all are done, the buffers come back in task order and stay
+        // valid until the next call
+        template<typename Task>
+        std::span<const VkCommandBuffer> record(std::uint32_t taskCount, Task&& task)
+        {
+            m_recorded.assign(taskCount, VK_NULL_HANDLE);
+
+            // Every task writes its own slot
+            m_jobSystem.parallelFor(taskCount, 1,
+                                    [this, &task](std::size_t begin, std::size_t end)
+                                    {
+                                        for(std::size_t index{begin}; index < end; ++index)
+                                        {
+                                            VkCommandBuffer commandBuffer{beginSecondary()};
+                                            task(commandBuffer, static_cast<std::uint32_t>(index));
+                                            endSecondary(commandBuffer);
+                                            m_recorded[index] = commandBuffer;
+                                        }
+                                    });
+
+            return m_recorded;
+        }
+
+        // A single secondary recorded right here with task(commandBuffer), e.g. for timestamps around a batch
+        template<typename Task>
+        VkCommandBuffer recordInline(Task&& task)
+        {
+            VkCommandBuffer commandBuffer{beginSecondary()};
+            task(commandBuffer);
+            endSecondary(commandBuffer);
+
+            return commandBuffer;
+        }
+
+        [[nodiscard]] std::uint32_t getThreadCount(void) const { return m_jobSystem.getThreadCount(); }
+    };
+}
@@ -6,6 +6,8 @@
 #include <vulkan/vulkan.h>
 
 // std
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -29,6 +31,10 @@ namespace VE
         // Destructor
         ~PipelineConfigInfo(void) = default;
 
+        // Defaults to Model::Vertex, render systems append their per-instance bindings
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
         VkPipelineViewportStateCreateInfo viewportInfo{};
         VkPipelineRasterizationStateCreateInfo rasterizationInfo{};
@@ -56,14 +62,10 @@ namespace VE
     public:  // Public variables
 
     private:  // Private methods
-        static std::vector<char> readFile(const std::string& filePath);
-
-        void createGraphicsPipeline(const std::string& vertFilePath,
-                                    const std::string& fragFilePath,
+        void createGraphicsPipeline(std::span<const std::uint32_t> vertCode,
+                                    std::span<const std::uint32_t> fragCode,
                                     const PipelineConfigInfo& configInfo);
 
-        void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
-
     public:  // Public methods
         /*------------------------------------------------------------------*/
         /*                 Don't copy or move my class!!!                   */
@@ -75,14 +77,48 @@ namespace VE
         /*------------------------------------------------------------------*/
 
         // Constructor
-        Pipeline(Device& device, const std::string& vertFilePath, const std::string& fragFilePath,
+        // Takes SPIR-V words, usually from the VE::Shaders arrays the build embeds
+        Pipeline(Device& device, std::span<const std::uint32_t> vertCode, std::span<const std::uint32_t> fragCode,
                  const PipelineConfigInfo& configInfo);
 
         // Destructor
         ~Pipeline(void);
 
+        // Only for SPIR-V that isn't embedded, like shaders recompiled while running
+        static std::vector<std::uint32_t> readSpirv(const std::string& filePath);
+
+        static VkShaderModule createShaderModule(Device& device, std::span<const std::uint32_t> code);
         static void defaultPipelineConfig(PipelineConfigInfo& configInfo);
 
         void bind(VkCommandBuffer commandBuffer);
     };
+
+    class ComputePipeline final
+    {
+    private:  // Private variables
+        Device& m_device;
+        VkPipeline m_computePipeline;
+        VkShaderModule m_compShaderModule;
+
+    private:  // Private methods
+        void createComputePipeline(std::span<const std::uint32_t> compCode, VkPipelineLayout pipelineLayout);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                 Don't copy or move my class!!!                   */
+
+        ComputePipeline(const ComputePipeline& copy) = delete;
+        ComputePipeline& operator=(const ComputePipeline& copy) = delete;
+        ComputePipeline(ComputePipeline&& move) = delete;
+        ComputePipeline& operator=(ComputePipeline&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        ComputePipeline(Device& device, std::span<const std::uint32_t> compCode, VkPipelineLayout pipelineLayout);
+
+        // Destructor
+        ~ComputePipeline(void);
+
+        void bind(VkCommandBuffer commandBuffer);
+    };
 }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Device.h"
+#include "Pipeline.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace VE
+{
+    struct PipelineRegistryStatistics
+    {
+        std::uint64_t hitCount{};
+        std::uint64_t missCount{};
+
+        // Pipelines someone still holds
+        std::size_t pipelineCount{};
+    };
+
+    // Hands out one shared pipeline per distinct shader code and configuration, only misses compile. Entries don't
+    // keep pipelines alive, the last holder destroys it. Render passes and layouts are compared by handle, so
+    // compatible but separately created ones still get pipelines of their own
+    class PipelineRegistry final
+    {
+    private:  // Private variables
+        Device& m_device;
+
+        // Hot reload rebuilds run on the shader watcher thread
+        std::mutex m_mutex;
+
+        // Keyed by the shader words followed by every setting that ends up in the pipeline
+        std::unordered_map<std::string, std::weak_ptr<Pipeline>> m_pipelines;
+        std::unordered_map<std::string, std::weak_ptr<ComputePipeline>> m_computePipelines;
+
+        std::uint64_t m_hitCount;
+        std::uint64_t m_missCount;
+
+    public:  // Public variables
+
+    private:  // Private methods
+        [[nodiscard]] static std::string makeKey(std::span<const std::uint32_t> vertCode,
+                                                 std::span<const std::uint32_t> fragCode,
+                                                 const PipelineConfigInfo& configInfo);
+        [[nodiscard]] static std::string makeKey(std::span<const std::uint32_t> compCode,
+                                                 VkPipelineLayout pipelineLayout);
+
+        // Returns the live pipeline under key, or stores and returns what create() builds
+        template<typename T, typename Create>
+        std::shared_ptr<T> getOrCreate(std::unordered_map<std::string, std::weak_ptr<T>>& pipelines,
+                                       std::string&& key,
+                                       Create create);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        PipelineRegistry(const PipelineRegistry& copy) = delete;
+        PipelineRegistry& operator=(const PipelineRegistry& copy) = delete;
+        PipelineRegistry(PipelineRegistry&& move) = delete;
+        PipelineRegistry& operator=(PipelineRegistry&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        PipelineRegistry(Device& device);
+
+        // Destructor
+        ~PipelineRegistry(void) = default;
+
+        [[nodiscard]] std::shared_ptr<Pipeline> getPipeline(std::span<const std::uint32_t> vertCode,
+                                                            std::span<const std::uint32_t> fragCode,
+                                                            const PipelineConfigInfo& configInfo);
+        [[nodiscard]] std::shared_ptr<ComputePipeline> getComputePipeline(std::span<const std::uint32_t> compCode,
+                                                                          VkPipelineLayout pipelineLayout);
+
+        [[nodiscard]] PipelineRegistryStatistics getStatistics(void);
+    };
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Device.h"
+#include "FrameInfo.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace VE
+{
+    // How a pass touches a resource, decides the stages, access masks and image layout of the barriers
+    enum class ResourceUsage : std::uint32_t
+    {
+        ColorAttachment,
+        DepthAttachment,
+        FragmentSampled,
+        ComputeSampled,
+        VertexStorageRead,
+        ComputeStorageRead,
+        ComputeStorageWrite,
+        IndirectRead,
+        TransferSrc,
+        TransferDst
+    };
+
+    // Frame passes declare what they read and write, the graph orders nothing but derives everything else from it:
+    // passes whose results never reach an output are skipped, one barrier per pass covers all of its hazards and
+    // transient images whose lifetimes don't overlap share memory. Build and compile once, then execute every frame
+    class RenderGraph final
+    {
+    public:  // Public variables
+        using ResourceHandle = std::uint32_t;
+        using PassHandle = std::uint32_t;
+
+        // The graph begins a render pass around the callback if all of the pass's attachments are transient.
+        // Passes that also draw into imported images begin their own and take the views from getImageView()
+        using PassCallback = std::function<void(FrameInfo& frameInfo)>;
+
+        struct ImageDesc
+        {
+            VkFormat format{VK_FORMAT_UNDEFINED};
+
+            // Used by the render pass of the first pass writing the image each frame
+            VkClearValue clearValue{};
+        };
+
+    private:  // Private variables
+        static constexpr std::size_t NO_PASS{~std::size_t{}};
+
+        // Layout transitions count as writes of the stages they were made for
+        struct ResourceState
+        {
+            VkPipelineStageFlags writeStages{};
+            VkAccessFlags writeAccess{};
+
+            // Reads since the last write, and which of them already saw it
+            VkPipelineStageFlags readStages{};
+            VkPipelineStageFlags visibleStages{};
+            VkAccessFlags visibleAccess{};
+
+            VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        };
+
+        struct Resource
+        {
+            std::string name;
+            bool isImage{};
+            bool imported{};
+            bool output{};
+
+            // Imported handles are set every frame, transient images are created by compile() and resize()
+            VkBuffer buffer{VK_NULL_HANDLE};
+            VkImage image{VK_NULL_HANDLE};
+            VkImageView view{VK_NULL_HANDLE};
+            VkImageLayout importedLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+            ImageDesc desc{};
+            VkImageUsageFlags imageUsage{};
+            VkImageAspectFlags aspect{VK_IMAGE_ASPECT_COLOR_BIT};
+            VkMemoryRequirements requirements{};
+
+            // Pass indices of the first and last live access, transient images only. Unused ones are never created
+            std::size_t firstPass{NO_PASS};
+            std::size_t lastPass{};
+            std::size_t memorySlot{};
+
+            // Set at the start of every frame, the first access takes over the state of the memory slot
+            bool firstUse{};
+            ResourceState state{};
+        };
+
+        struct Access
+        {
+            ResourceHandle resource{};
+            ResourceUsage usage{};
+            bool write{};
+        };
+
+        struct Pass
+        {
+            std::string name;
+            PassCallback callback;
+            std::vector<Access> accesses;
+            bool live{};
+
+            // Only for passes whose attachments are all transient
+            VkRenderPass renderPass{VK_NULL_HANDLE};
+            VkFramebuffer framebuffer{VK_NULL_HANDLE};
+            std::vector<ResourceHandle> attachments;
+            std::vector<VkClearValue> clearValues;
+        };
+
+        // Memory shared by transient images that are never alive at the same time
+        struct MemorySlot
+        {
+            VkMemoryRequirements requirements{};
+            Allocation allocation{};
+            std::vector<ResourceHandle> images;
+
+            // Last access of whichever image used the memory last, the next one waits for it. Kept across frames,
+            // the next frame reuses the memory
+            ResourceState state{};
+        };
+
+        // What resize() replaced, destroyed once the frame timeline passed frameNumber
+        struct RetiredResources
+        {
+            std::uint64_t frameNumber{};
+            std::vector<VkFramebuffer> framebuffers;
+            std::vector<VkImageView> views;
+            std::vector<VkImage> images;
+            std::vector<Allocation> allocations;
+        };
+
+        Device& m_device;
+        VkExtent2D m_extent;
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+        std::vector<MemorySlot> m_memorySlots;
+        std::vector<RetiredResources> m_retiredResources;
+        bool m_compiled;
+
+        // Scratch for execute(), kept to avoid allocating every frame
+        std::vector<VkImageMemoryBarrier> m_imageBarriers;
+        std::vector<VkBufferMemoryBarrier> m_bufferBarriers;
+
+    private:  // Private methods
+        void cullPasses(void);
+        void computeLifetimes(void);
+        void createTransientImages(void);
+        void aliasTransientImages(void);
+        void createRenderPass(Pass& pass);
+        void createFramebuffer(Pass& pass);
+
+        // Destroys what the GPU is done with, or everything if waitAll is set
+        void collectRetiredResources(bool waitAll);
+
+        // Adds what the access needs to the pending barriers and moves the resource into its new state
+        void transition(const Access& access, VkPipelineStageFlags& srcStages, VkPipelineStageFlags& dstStages);
+
+        [[nodiscard]] static bool isTransient(const Resource& resource)
+        {
+            return resource.isImage && !resource.imported;
+        }
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        RenderGraph(const RenderGraph& copy) = delete;
+        RenderGraph& operator=(const RenderGraph& copy) = delete;
+        RenderGraph(RenderGraph&& move) = delete;
+        RenderGraph& operator=(RenderGraph&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor, transient images are extent sized
+        RenderGraph(Device& device, VkExtent2D extent);
+
+        // Destructor
+        ~RenderGraph(void);
+
+        // Owned by the graph, only valid during the frame. Their contents don't survive it
+        ResourceHandle createImage(const std::string& name, const ImageDesc& desc);
+
+        // Owned by someone else, which also synchronizes them with earlier frames. Every frame starts with no
+        // pending access. Imports left without a handle only order and keep passes alive, they get no barriers.
+        // The format decides which aspects the image barriers cover
+        ResourceHandle importBuffer(const std::string& name);
+        ResourceHandle importImage(const std::string& name, VkFormat format);
+
+        // Passes writing outputs, and whatever they read from, are the ones that run
+        void markOutput(ResourceHandle resource);
+
+        // Passes run in the order they were added
+        PassHandle addPass(const std::string& name, PassCallback callback);
+        void read(PassHandle pass, ResourceHandle resource, ResourceUsage usage);
+        void write(PassHandle pass, ResourceHandle resource, ResourceUsage usage);
+
+        // Culls the passes, creates and aliases the transient images and builds their render passes
+        void compile(void);
+
+        // Recreates the transient images and framebuffers at a new extent, nothing happens if it didn't change.
+        // lastSubmittedFrame is the newest frame that may use the replaced ones
+        void resize(VkExtent2D extent, std::uint64_t lastSubmittedFrame);
+
+        // Per frame handles of imported resources, layout is what the image is in when the frame starts
+        void setBuffer(ResourceHandle resource, VkBuffer buffer);
+        void setImage(ResourceHandle resource, VkImage image, VkImageLayout layout);
+
+        // Records every live pass into frameInfo.commandBuffer, outside of any render pass
+        void execute(FrameInfo& frameInfo);
+
+        [[nodiscard]] bool isPassLive(PassHandle pass) const { return m_passes[pass].live; }
+
+        // Transient images only, valid from compile() until the next resize() changes the extent
+        [[nodiscard]] VkImageView getImageView(ResourceHandle resource) const { return m_resources[resource].view; }
+
+        // Device memory behind the transient images, with and without aliasing
+        [[nodiscard]] VkDeviceSize getTransientMemorySize(void) const;
+        [[nodiscard]] VkDeviceSize getUnaliasedMemorySize(void) const;
+    };
+}
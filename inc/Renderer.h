@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Device.h"
+#include "FrameArena.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
 #include "Model.h"
+#include "ParallelCommandRecorder.h"
 #include "SwapChain.h"
 #include "Window.h"
 
@@ -21,17 +25,33 @@ namespace VE
     private:  // Private variables
         Window& m_window;
         Device& m_device;
+        GpuProfiler m_gpuProfiler;
         std::unique_ptr<SwapChain> m_swapChain;
+        VkPresentModeKHR m_presentMode;
         std::vector<VkCommandBuffer> m_commandBuffers;
 
+        // Render pass contents come from secondaries recorded by these threads
+        ParallelCommandRecorder m_commandRecorder;
+
+        // Transient CPU data of each frame in flight, reset once the GPU has finished its previous frame
+        std::vector<std::unique_ptr<FrameArena>> m_frameArenas;
+
         // Track the current image that is in progress
         std::uint32_t m_currentImageIndex;
         bool m_isFrameStarted;
 
-        // Track frame index in this range [0, MAX_FRAMES_IN_FLIGHT]
+        // Track frame index in this range [0, m_framesInFlight)
         // Doesn't depend on m_currentImageIndex
+        std::uint32_t m_framesInFlight;
         std::uint32_t m_currentFrameIndex;
 
+        // Frames submitted so far, the next one signals m_frameNumber + 1 on the frame timeline
+        std::uint64_t m_frameNumber;
+
+        // GPU timestamps around the whole command buffer and the swap chain render pass
+        std::uint32_t m_frameScope;
+        std::uint32_t m_renderPassScope;
+
     public:  // Public variables
 
     private:  // Private methods
@@ -50,7 +70,11 @@ namespace VE
         /*------------------------------------------------------------------*/
 
         // Constructor
-        Renderer(Window& window, Device& device);
+        Renderer(Window& window,
+                 Device& device,
+                 JobSystem& jobSystem,
+                 std::uint32_t framesInFlight,
+                 VkPresentModeKHR presentMode);
 
         // Destructor
         ~Renderer(void);
@@ -58,14 +82,28 @@ namespace VE
         VkCommandBuffer beginFrame(void);
         void endFrame(void);
 
-        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+        // The subpass takes secondary command buffers only, record them with getCommandRecorder(). The depth buffer
+        // belongs to the render graph, it has to be in the depth attachment layout already
+        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkImageView depthView);
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
         // Getters
         [[nodiscard]] bool isFrameInProgress(void) const { return m_isFrameStarted; }
         [[nodiscard]] VkRenderPass getSwapChainRenderPass(void) const { return m_swapChain->getRenderPass(); }
+        [[nodiscard]] VkFormat getSwapChainImageFormat(void) const { return m_swapChain->getSwapChainImageFormat(); }
+        [[nodiscard]] VkFormat getSwapChainDepthFormat(void) const { return m_swapChain->getSwapChainDepthFormat(); }
+        [[nodiscard]] VkExtent2D getSwapChainExtent(void) const { return m_swapChain->getSwapChainExtent(); }
         [[nodiscard]] float getSwapChainAspectRatio(void) const { return m_swapChain->extentAspectRatio(); }
         [[nodiscard]] VkCommandBuffer getCurrentCommandBuffer(void) const;
         [[nodiscard]] std::uint32_t getFrameIndex(void) const;
+        [[nodiscard]] std::uint32_t getFramesInFlight(void) const { return m_framesInFlight; }
+
+        // Number of the frame being recorded, and the newest one the GPU has finished
+        [[nodiscard]] std::uint64_t getFrameNumber(void) const { return m_frameNumber + 1; }
+        [[nodiscard]] std::uint64_t getCompletedFrame(void) { return m_device.getCompletedFrame(); }
+
+        [[nodiscard]] GpuProfiler& getGpuProfiler(void) { return m_gpuProfiler; }
+        [[nodiscard]] ParallelCommandRecorder& getCommandRecorder(void) { return m_commandRecorder; }
+        [[nodiscard]] FrameArena& getFrameArena(void) { return *m_frameArenas[getFrameIndex()]; }
     };
 }
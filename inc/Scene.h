@@ -0,0 +1,126 @@
+#pragma once
+
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "Model.h"
+
+// glm
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace VE
+{
+    // Dense structure of arrays storage for everything that gets rendered.
+    // Object i lives at index i of every component array. Local matrices are cached and only rebuilt
+    // (in SIMD batches) when a setter touched them, world matrices follow the parent links
+    class Scene final
+    {
+    public:  // Public variables
+        using ObjectId = std::uint32_t;
+        static constexpr ObjectId NO_PARENT{std::numeric_limits<ObjectId>::max()};
+
+    private:  // Private variables
+        std::vector<float> m_translationX;
+        std::vector<float> m_translationY;
+        std::vector<float> m_translationZ;
+        std::vector<float> m_rotationX;
+        std::vector<float> m_rotationY;
+        std::vector<float> m_rotationZ;
+        std::vector<float> m_scaleX;
+        std::vector<float> m_scaleY;
+        std::vector<float> m_scaleZ;
+
+        std::vector<glm::vec3> m_colors;
+        std::vector<ObjectId> m_parents;
+        std::vector<glm::mat4> m_localMatrices;
+        std::vector<glm::mat4> m_worldMatrices;
+
+        // Bytes rather than std::vector<bool>, they're scanned a register at a time
+        std::vector<std::uint8_t> m_localDirty;
+        std::vector<std::uint8_t> m_worldDirty;
+        bool m_anyDirty{};
+
+        // Parents always come before their children, rebuilt only when the hierarchy changes.
+        // Depth d occupies [m_levelOffsets[d], m_levelOffsets[d + 1]) of m_updateOrder
+        std::vector<ObjectId> m_updateOrder;
+        std::vector<std::size_t> m_levelOffsets;
+        bool m_hierarchyChanged{};
+
+        // Bumped whenever anything a renderer copies out changed, lets GPU side copies skip unchanged frames
+        std::uint64_t m_version{};
+
+        // Smaller ranges cost more in scheduling than they save
+        static constexpr std::size_t MIN_OBJECTS_PER_JOB{4096};
+
+        // Raw pointers for the render loop, the shared_ptrs below keep the models alive
+        std::vector<Model*> m_models;
+        std::unordered_map<Model*, std::shared_ptr<Model>> m_ownedModels;
+
+    private:  // Private methods
+        void markDirty(ObjectId object);
+        void buildUpdateOrder(void);
+
+        // Rebuilds whole registers worth of local matrices that contain a dirty object, advances first past them
+        void updateLocalMatricesBatch(std::size_t& first, std::size_t end);
+        void updateLocalMatrices(std::size_t begin, std::size_t end);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        Scene(const Scene& copy) = delete;
+        Scene& operator=(const Scene& copy) = delete;
+        Scene(Scene&& move) = delete;
+        Scene& operator=(Scene&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        Scene(void) = default;
+
+        // Destructor
+        ~Scene(void) = default;
+
+        void reserve(std::size_t objectCount);
+
+        ObjectId createObject(std::shared_ptr<Model> model,
+                              const TransformComponent& transform = {},
+                              glm::vec3 color = glm::vec3{1.0F},
+                              ObjectId parent = NO_PARENT);
+
+        // The child's transform becomes relative to the parent, throws if that would create a cycle
+        void setParent(ObjectId child, ObjectId parent);
+        [[nodiscard]] ObjectId getParent(ObjectId object) const { return m_parents[object]; }
+
+        void setTranslation(ObjectId object, glm::vec3 translation);
+        void setRotation(ObjectId object, glm::vec3 rotation);
+        void setScale(ObjectId object, glm::vec3 scale);
+        void setColor(ObjectId object, glm::vec3 color)
+        {
+            m_colors[object] = color;
+            ++m_version;
+        }
+
+        [[nodiscard]] glm::vec3 getTranslation(ObjectId object) const;
+        [[nodiscard]] glm::vec3 getRotation(ObjectId object) const;
+        [[nodiscard]] glm::vec3 getScale(ObjectId object) const;
+
+        // Same convention as TransformComponent::mat4(): scale, rotate around z, x, y, translate.
+        // Costs nothing if no transform or parent changed since the last call
+        void updateWorldMatrices(JobSystem& jobSystem);
+
+        [[nodiscard]] std::size_t size(void) const { return m_models.size(); }
+        [[nodiscard]] std::uint64_t getVersion(void) const { return m_version; }
+        [[nodiscard]] std::span<const glm::mat4> getWorldMatrices(void) const { return m_worldMatrices; }
+        [[nodiscard]] std::span<Model* const> getModels(void) const { return m_models; }
+        [[nodiscard]] std::span<const glm::vec3> getColors(void) const { return m_colors; }
+    };
+}
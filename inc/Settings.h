@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FrameStatistics.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VE
+{
+    struct Settings
+    {
+        std::int32_t width{800};
+        std::int32_t height{600};
+
+        // Render into an offscreen image ring instead of a GLFW window/surface
+        bool headless{};
+
+        // Stop after this many frames, 0 means run until the window is closed.
+        // In benchmark mode this counts the measured frames only
+        std::uint64_t maxFrames{};
+
+        // Run warm-up frames, at least one, then record every measured CPU frame time and write a report
+        bool benchmark{};
+        std::uint64_t warmupFrames{120};
+        std::string reportPath;
+        ReportFormat reportFormat{ReportFormat::Json};
+
+        // .obj files to load next to the built-in cube, one "--model <path>" each
+        std::vector<std::string> modelPaths;
+
+        // Extra cubes laid out in a grid, for stressing the per-object paths
+        std::uint64_t cubeCount{};
+
+        // Job system workers including the main thread, 0 means one per hardware thread
+        std::uint32_t workerThreads{};
+        bool pinThreads{};
+
+        // 1 keeps latency lowest, more let the CPU run ahead of the GPU (up to SwapChain::MAX_FRAMES_IN_FLIGHT)
+        std::uint32_t framesInFlight{2};
+
+        // FIFO never tears and is always there, MAILBOX is tear-free with low latency, IMMEDIATE has the lowest
+        // latency. Falls back to FIFO when the surface doesn't offer the requested mode
+        VkPresentModeKHR presentMode{VK_PRESENT_MODE_FIFO_KHR};
+
+        // Caps the main loop, 0 means as fast as the present mode allows
+        double fpsLimit{};
+
+        // Cull and build the draw commands in a compute pass instead of on the CPU
+        bool gpuCulling{};
+
+        // Recompile shaders saved while running and swap in the rebuilt pipelines
+        bool hotReload{};
+
+        // Parse the command line, throws on unknown or malformed options
+        static Settings fromCommandLine(int argc, char** argv);
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Device.h"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VE
+{
+    // Recompiles shaders when their GLSL source in the watched directory is saved and rebuilds the pipelines
+    // using them, both on a thread of its own. Finished rebuilds wait until applyReloads() swaps them in at a
+    // frame boundary, the render loop never waits for a compile. Needs inotify, elsewhere nothing gets reloaded
+    class ShaderWatcher final
+    {
+    public:  // Public variables
+        // Installs the rebuilt object on the render thread and hands back the one it replaced
+        using Swap = std::function<std::shared_ptr<void>(void)>;
+
+        // Runs on the watcher thread, throwing keeps the old pipeline
+        using Rebuild = std::function<Swap(void)>;
+
+    private:  // Private variables
+        struct Watch
+        {
+            // Full paths of the GLSL sources, compiled to <source>.spv next to them like the build does
+            std::vector<std::string> sources;
+            Rebuild rebuild;
+        };
+
+        // Replaced objects, the frames recorded with them may still be on the GPU
+        struct Retired
+        {
+            std::uint64_t frameNumber{};
+            std::shared_ptr<void> object;
+        };
+
+        Device& m_device;
+        std::string m_directory;
+
+        std::mutex m_mutex;
+        std::vector<Watch> m_watches;
+        std::vector<Swap> m_pendingSwaps;
+
+        // Render thread only
+        std::vector<Retired> m_retired;
+
+        int m_inotify;
+
+        // Last member, so it is stopped and joined before anything it uses goes away
+        std::jthread m_thread;
+
+    private:  // Private methods
+        void watchLoop(std::stop_token stopToken);
+
+        // File names of the changed shader sources, waits a little for editors that save in several writes
+        [[nodiscard]] std::set<std::string> readChanges(void);
+
+        [[nodiscard]] static bool compile(const std::string& source);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        ShaderWatcher(const ShaderWatcher& copy) = delete;
+        ShaderWatcher& operator=(const ShaderWatcher& copy) = delete;
+        ShaderWatcher(ShaderWatcher&& move) = delete;
+        ShaderWatcher& operator=(ShaderWatcher&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor, watches the shader directory of the source tree
+        explicit ShaderWatcher(Device& device);
+
+        // Destructor
+        ~ShaderWatcher(void);
+
+        // Calls rebuild whenever one of sources, file names in the shader directory, has been recompiled
+        void watch(const std::vector<std::string>& sources, Rebuild rebuild);
+
+        // At a frame boundary, lastSubmittedFrame is the newest frame that may use the replaced objects.
+        // Only takes what is already built and skips the frame if the watcher thread holds the lock
+        void applyReloads(std::uint64_t lastSubmittedFrame);
+
+        [[nodiscard]] bool isEnabled(void) const { return m_inotify >= 0; }
+
+        // Where the watcher puts the SPIR-V it compiles for source, e.g. "simple.vert"
+        [[nodiscard]] static std::string spirvPath(const std::string& source);
+
+        // Rebuild that replaces target, a unique or shared pointer, with what create() returns
+        template<typename Pointer, typename Create>
+        static Rebuild replace(Pointer& target, Create create)
+        {
+            return [&target, create]
+            {
+                // Holds the new object until the swap, then the old one until it is retired
+                auto object{std::make_shared<Pointer>(create())};
+                return Swap{[&target, object]
+                            {
+                                std::swap(target, *object);
+                                return std::shared_ptr<void>{object};
+                            }};
+            };
+        }
+    };
+}
@@ -1,18 +1,28 @@
 #pragma once
 
 #include "Device.h"
-#include "GameObject.h"
+#include "FrameInfo.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
 #include "Model.h"
 #include "Pipeline.h"
+#include "PipelineRegistry.h"
+#include "Scene.h"
 #include "Camera.h"
+#include "ShaderWatcher.h"
+#include "SwapChain.h"
 
 // vulkan headers
 #include <vulkan/vulkan.h>
 
 // std
+#include <array>
 #include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace VE
@@ -21,15 +31,54 @@ namespace VE
     {
     private:  // Private variables
         Device& m_device;
-        std::unique_ptr<Pipeline> m_pipeline;
+        JobSystem& m_jobSystem;
+        PipelineRegistry& m_pipelineRegistry;
+        std::shared_ptr<Pipeline> m_pipeline;
         VkPipelineLayout m_pipelineLayout;
+        VkRenderPass m_renderPass;
+
+        // Per-instance transforms and colors, one mapped buffer per frame in flight
+        struct InstanceBuffer
+        {
+            VkBuffer buffer{VK_NULL_HANDLE};
+            Allocation allocation{};
+            std::size_t capacity{};
+        };
+        std::array<InstanceBuffer, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceBuffers;
+
+        // Kept around so a frame doesn't allocate, the other per frame lists live in the frame arena
+        FrustumCuller m_culler;
+        SphereBatch m_spheres;  // one per object, indexed by ObjectId
+
+        // A visible object, sorted by model every run of equal models becomes one instanced draw
+        using DrawItem = std::pair<Model*, Scene::ObjectId>;
+
+        // Below these a range isn't worth another job
+        static constexpr std::size_t MIN_OBJECTS_PER_CULL_RANGE{4096};
+        static constexpr std::size_t MIN_INSTANCES_PER_TASK{4096};
 
     public:  // Public variables
-        void renderGameObjects(VkCommandBuffer commandBuffer, std::vector<GameObject>& gameObjects, const Camera& camera);
+        // Culls against the camera frustum, then one instanced draw per distinct visible model
+        void renderScene(FrameInfo& frameInfo, const Scene& scene);
 
     private:  // Private methods
-        void createPipelineLayout(void);
-        void createPipeline(VkRenderPass renderPass);
+        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+
+        // Also called on the shader watcher thread, only reads what the constructor set up
+        [[nodiscard]] std::shared_ptr<Pipeline> createPipeline(std::span<const std::uint32_t> vertCode,
+                                                               std::span<const std::uint32_t> fragCode) const;
+
+        // Only grows, the frame that used this slot last has already finished
+        InstanceBuffer& getInstanceBuffer(std::uint32_t frameIndex, std::size_t instanceCount);
+
+        // Fills and draws instances [first, last) of drawOrder, runs on the recording threads
+        void recordDraws(VkCommandBuffer commandBuffer,
+                         const InstanceBuffer& instanceBuffer,
+                         const Scene& scene,
+                         VkDescriptorSet globalDescriptorSet,
+                         std::span<const DrawItem> drawOrder,
+                         std::size_t first,
+                         std::size_t last) const;
 
     public:  // Public methods
         /*------------------------------------------------------------------*/
@@ -42,9 +91,16 @@ namespace VE
         /*------------------------------------------------------------------*/
 
         // Constructor
-        SimpleRenderSystem(Device& device, VkRenderPass renderPass);
+        SimpleRenderSystem(Device& device,
+                           JobSystem& jobSystem,
+                           PipelineRegistry& pipelineRegistry,
+                           VkRenderPass renderPass,
+                           VkDescriptorSetLayout globalSetLayout);
 
         // Destructor
         ~SimpleRenderSystem(void);
+
+        // Rebuilds the pipeline when simple.vert or simple.frag change
+        void watchShaders(ShaderWatcher& watcher);
     };
 }
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "MemoryAllocator.h"
+
+// Vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace VE
+{
+    class Device;
+
+    // A persistently mapped host visible ring that feeds device local buffers.
+    // Copies are recorded as they come and go to the GPU in one submission per flush(),
+    // ring space is recycled as the upload timeline passes older submissions.
+    // With a dedicated transfer queue the copies run there and the destination ranges are handed over
+    // to the graphics family, whose acquire half is submitted right away so frames see the data in queue order
+    class StagingRing final
+    {
+    private:  // Private variables
+        struct Submission
+        {
+            VkCommandBuffer commandBuffer;
+            VkCommandBuffer acquireCommandBuffer;  // VK_NULL_HANDLE without a dedicated transfer queue
+
+            // Done once the upload timeline reaches it
+            std::uint64_t timelineValue;
+
+            // Ring position right after the last byte this submission reads
+            VkDeviceSize end;
+        };
+
+        Device& m_device;
+        VkBuffer m_buffer;
+        Allocation m_allocation;
+        VkDeviceSize m_capacity;
+
+        // Monotonic positions, the ring offset is position % m_capacity
+        VkDeviceSize m_head;
+        VkDeviceSize m_tail;
+
+        // Copies are recorded for the transfer family, ownership is acquired on the graphics family
+        std::uint32_t m_transferFamily;
+        std::uint32_t m_graphicsFamily;
+        VkCommandPool m_commandPool;
+        VkCommandPool m_acquireCommandPool;
+
+        VkCommandBuffer m_recording;
+        std::vector<VkBufferMemoryBarrier> m_ownershipBarriers;
+        std::deque<Submission> m_inFlight;
+        std::vector<VkCommandBuffer> m_freeCommandBuffers;
+        std::vector<VkCommandBuffer> m_freeAcquireCommandBuffers;
+
+        // Signalled with a new value by every flush, replaces a fence per submission
+        VkSemaphore m_timeline;
+        std::uint64_t m_timelineValue;
+        std::mutex m_mutex;
+
+    public:  // Public variables
+        static constexpr VkDeviceSize DEFAULT_CAPACITY{32ULL * 1024 * 1024};
+
+    private:  // Private methods
+        void createCommandPools(void);
+        void createTimeline(void);
+        [[nodiscard]] bool hasOwnershipTransfer(void) const { return m_transferFamily != m_graphicsFamily; }
+
+        // Returns the ring offset of size free bytes, waits for old submissions when the ring is full
+        VkDeviceSize reserve(VkDeviceSize size);
+        void reclaim(bool wait);
+        VkCommandBuffer getRecordingCommandBuffer(void);
+        VkCommandBuffer allocateCommandBuffer(VkCommandPool commandPool, std::vector<VkCommandBuffer>& freeList);
+        void flushLocked(void);
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        StagingRing(const StagingRing& copy) = delete;
+        StagingRing& operator=(const StagingRing& copy) = delete;
+        StagingRing(StagingRing&& move) = delete;
+        StagingRing& operator=(StagingRing&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor
+        StagingRing(Device& device, VkDeviceSize capacity = DEFAULT_CAPACITY);
+
+        // Destructor
+        ~StagingRing(void);
+
+        // Copies data into the ring and records a copy into dstBuffer, nothing is submitted yet
+        void upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+        // Submits every copy recorded since the last flush in a single vkQueueSubmit
+        void flush(void);
+
+        // Flushes and blocks until every upload has landed
+        void waitIdle(void);
+    };
+}
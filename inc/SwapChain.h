@@ -21,39 +21,70 @@ namespace VE
 
         VkExtent2D m_swapChainExtent;
 
+        // Created on first use, the depth view belongs to the render graph and is remembered to tell when it changed
         std::vector<VkFramebuffer> m_swapChainFramebuffers;
+        std::vector<VkImageView> m_framebufferDepthViews;
         VkRenderPass m_renderPass;
 
-        std::vector<VkImage> m_depthImages;
-        std::vector<VkDeviceMemory> m_depthImageMemorys;
-        std::vector<VkImageView> m_depthImageViews;
         std::vector<VkImage> m_swapChainImages;
         std::vector<VkImageView> m_swapChainImageViews;
 
+        // Headless mode owns its color images instead of borrowing them from a VkSwapchainKHR
+        std::vector<Allocation> m_offscreenImageAllocations;
+        std::uint32_t m_nextOffscreenImage;
+
         Device& m_device;
         VkExtent2D m_windowExtent;
 
         VkSwapchainKHR m_swapChain;
-        std::shared_ptr<SwapChain> m_oldSwapChain;
 
+        // Used if the surface supports it, FIFO otherwise
+        VkPresentModeKHR m_preferredPresentMode;
+
+        // One of each per frame in flight, the frame timeline tells when a slot may be reused
+        std::uint32_t m_framesInFlight;
         std::vector<VkSemaphore> m_imageAvailableSemaphores;
         std::vector<VkSemaphore> m_renderFinishedSemaphores;
-        std::vector<VkFence> m_inFlightFences;
-        std::vector<VkFence> m_imagesInFlight;
+
+        // Frame number that last rendered into each image, an image can come back before its frame slot does
+        std::vector<std::uint64_t> m_imageFrames;
         std::size_t m_currentFrame;
 
+        // Last frame number submitted, resources replaced by recreate() are tagged with it
+        std::uint64_t m_lastFrameNumber;
+
+        // What recreate() replaced, destroyed once the frame timeline passed frameNumber. There is no way to tell
+        // when a present has finished without VK_EXT_swapchain_maintenance1, the frame that rendered the image is
+        // the usual stand-in
+        struct RetiredResources
+        {
+            std::uint64_t frameNumber{};
+            VkSwapchainKHR swapChain{VK_NULL_HANDLE};
+            std::vector<VkImage> offscreenImages;
+            std::vector<Allocation> offscreenImageAllocations;
+            std::vector<VkImageView> imageViews;
+            std::vector<VkFramebuffer> framebuffers;
+        };
+        std::vector<RetiredResources> m_retiredResources;
+
     public:  // Public variables
-        static constexpr int MAX_FRAMES_IN_FLIGHT{2};
+        // Upper bound of the runtime frames in flight, sizes the per frame arrays of the render systems
+        static constexpr std::uint32_t MAX_FRAMES_IN_FLIGHT{4};
 
     private:  // Private methods
         void init(void);
-        void createSwapChain(void);
+        void createSwapChain(VkSwapchainKHR oldSwapChain);
+        void createOffscreenImages(void);
         void createImageViews(void);
-        void createDepthResources(void);
         void createRenderPass(void);
         void createFramebuffers(void);
         void createSyncObjects(void);
 
+        void destroyRetiredResources(RetiredResources& retired);
+
+        // Destroys what the GPU is done with, or everything if waitAll is set
+        void collectRetiredResources(bool waitAll);
+
         /*------------------------------------------------------------------*/
         /*                         Helper Functions                         */
 
@@ -73,10 +104,10 @@ namespace VE
         /*------------------------------------------------------------------*/
 
         // Constructor
-        SwapChain(Device& device, VkExtent2D windowExtent);
-
-        // Constructor
-        SwapChain(Device& device, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previousSwapChain);
+        SwapChain(Device& device,
+                  VkExtent2D windowExtent,
+                  std::uint32_t framesInFlight,
+                  VkPresentModeKHR presentMode);
 
         // Destructor
         ~SwapChain(void);
@@ -84,11 +115,11 @@ namespace VE
         /*------------------------------------------------------------------*/
         /*                             Getters                              */
 
-        VkFramebuffer getFrameBuffer(std::uint32_t index) { return m_swapChainFramebuffers[index]; }
         VkRenderPass getRenderPass(void) { return m_renderPass; }
         VkImageView getImageView(std::uint32_t index) { return m_swapChainImageViews[index]; }
         std::size_t imageCount(void) { return m_swapChainImages.size(); }
         VkFormat getSwapChainImageFormat(void) { return m_swapChainImageFormat; }
+        VkFormat getSwapChainDepthFormat(void) { return m_swapChainDepthFormat; }
         VkExtent2D getSwapChainExtent(void) { return m_swapChainExtent; }
         [[nodiscard]] std::uint32_t width(void) const { return m_swapChainExtent.width; }
         [[nodiscard]] std::uint32_t height(void) const { return m_swapChainExtent.height; }
@@ -100,8 +131,21 @@ namespace VE
         }
         VkFormat findDepthFormat(void);
 
+        // Rebuilds the images for a new window extent without waiting for the device. The render pass and the
+        // semaphores are kept and everything replaced is destroyed once the frames that used it have finished.
+        // Throws if the surface format changed, since the pipelines were built against the render pass
+        void recreate(VkExtent2D windowExtent);
+
+        // The framebuffer of an image, created or replaced if depthView isn't the one it was made with
+        VkFramebuffer getFrameBuffer(std::uint32_t index, VkImageView depthView);
+
+        // The caller has waited for the frame that used the current frame slot last
         VkResult acquireNextImage(std::uint32_t* imageIndex);
-        VkResult submitCommandBuffers(const VkCommandBuffer* commandBuffer, std::uint32_t* imageIndex);
+
+        // Signals frameNumber on the device's frame timeline once the command buffer has finished
+        VkResult submitCommandBuffers(const VkCommandBuffer* commandBuffer,
+                                      std::uint32_t* imageIndex,
+                                      std::uint64_t frameNumber);
 
         [[nodiscard]] bool compareSwapChainFormats(const SwapChain& swap) const
         {
@@ -19,6 +19,9 @@ namespace VE
         std::string m_name;
         bool m_framebufferResized;
 
+        // No GLFW window or surface, the extent is fixed at construction
+        bool m_headless;
+
     public:  // Public variables
 
     private:  // Private methods
@@ -36,7 +39,7 @@ namespace VE
         /*------------------------------------------------------------------*/
 
         // Constructor
-        Window(std::int32_t width, std::int32_t height, const std::string& name);
+        Window(std::int32_t width, std::int32_t height, const std::string& name, bool headless = false);
 
         // Destructor
         ~Window(void);
@@ -44,10 +47,11 @@ namespace VE
         bool shouldClose(void);
         void pollEvents(void);
         void createWindowSurface(VkInstance instance, VkSurfaceKHR* surface);
-        static std::vector<const char*> getInstanceExtensions(void);
+        [[nodiscard]] std::vector<const char*> getInstanceExtensions(void) const;
         VkExtent2D getExtent(void);
         [[nodiscard]] bool wasWindowResized(void) const;
         void resetWindowResizedFlag(void);
         GLFWwindow* getGLFWwindow(void) { return m_window; }
+        [[nodiscard]] bool isHeadless(void) const { return m_headless; }
     };
 }
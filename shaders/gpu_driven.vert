@@ -0,0 +1,55 @@
+#version 450
+
+// in variables
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+// out variables
+layout(location = 0) out vec3 outFragColor;
+
+// Matches GlobalUbo in GlobalUniforms.h
+layout(set = 0, binding = 0) uniform GlobalUbo
+{
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+    float time;
+    float frameTime;
+    uint frameIndex;
+} ubo;
+
+// Matches ObjectData in GpuDrivenRenderSystem.cc
+struct ObjectData
+{
+    mat4 transform;
+    vec4 color;
+    vec4 boundingSphere;
+    uint drawGroup;
+    uint visibleOffset;
+    uint padding0;
+    uint padding1;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Objects
+{
+    ObjectData objects[];
+};
+
+// Filled by cull.comp, this draw group's survivors start at push.visibleOffset
+layout(std430, set = 1, binding = 2) readonly buffer VisibleObjects
+{
+    uint visibleObjects[];
+};
+
+layout(push_constant) uniform Push
+{
+    uint visibleOffset;
+} push;
+
+void main(void)
+{
+    const uint object = visibleObjects[push.visibleOffset + gl_InstanceIndex];
+
+    gl_Position = ubo.projectionView * objects[object].transform * vec4(inPosition, 1.0F);
+    outFragColor = inColor * objects[object].color.rgb;
+}
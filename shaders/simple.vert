@@ -4,17 +4,26 @@
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
+// per instance
+layout(location = 2) in mat4 instanceTransform;
+layout(location = 6) in vec4 instanceColor;
+
 // out variables
 layout(location = 0) out vec3 outFragColor;
 
-layout(push_constant) uniform Push
+// Matches GlobalUbo in GlobalUniforms.h
+layout(set = 0, binding = 0) uniform GlobalUbo
 {
-    mat4 transform;
-    vec3 color;
-} push;
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+    float time;
+    float frameTime;
+    uint frameIndex;
+} ubo;
 
 void main(void)
 {
-    gl_Position = push.transform * vec4(inPosition, 1.0F);
-    outFragColor = inColor;
+    gl_Position = ubo.projectionView * instanceTransform * vec4(inPosition, 1.0F);
+    outFragColor = inColor * instanceColor.rgb;
 }
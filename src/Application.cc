@@ -1,8 +1,16 @@
 #include "Application.h"
+#include "FrameLimiter.h"
+#include "FrameStatistics.h"
 #include "FrameTime.h"
+#include "GlobalUniforms.h"
+#include "GpuDrivenRenderSystem.h"
+#include "PipelineRegistry.h"
+#include "RenderGraph.h"
+#include "ShaderWatcher.h"
 #include "SimpleRenderSystem.h"
 #include "Camera.h"
 #include "KeyboardMovementController.h"
+#include "MeshLoader.h"
 
 // glm
 #define GLM_FORCE_RADIANS
@@ -12,15 +20,24 @@
 
 // std
 #include <array>
+#include <cmath>
 #include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <map>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace VE
 {
     // Constructor
-    Application::Application(void)
-        : m_window{WIDTH, HEIGHT, "VulkanEngine"}, m_device{m_window}, m_renderer{m_window, m_device}
+    Application::Application(const Settings& settings)
+        : m_settings{settings},
+          m_window{settings.width, settings.height, "VulkanEngine", settings.headless},
+          m_device{m_window},
+          m_jobSystem{settings.workerThreads, settings.pinThreads},
+          m_renderer{m_window, m_device, m_jobSystem, settings.framesInFlight, settings.presentMode}
     {
         loadGameObjects();
     }
@@ -28,7 +45,8 @@ namespace VE
     // Destructor
     Application::~Application(void) = default;
 
-    // temporary helper function, creates a 1x1x1 cube centered at offset
+    // temporary helper function, creates a 1x1x1 cube centered at offset,
+    // welding the 36 corners of its triangles down to 24 indexed vertices
     static std::unique_ptr<Model> createCubeModel(Device& device, glm::vec3 offset)
     {
         std::vector<Model::Vertex> vertices{
@@ -86,54 +104,275 @@ namespace VE
         {
             vertex.position += offset;
         }
-        return std::make_unique<Model>(device, vertices);
+        return std::make_unique<Model>(device, Model::Builder::weld(vertices));
     }
 
     void Application::loadGameObjects(void)
     {
         std::shared_ptr<Model> model{createCubeModel(m_device, glm::vec3{0.0F})};
 
-        auto cube{GameObject::createGameObject()};
-        cube.model = model;
-        cube.transform.translation = {0.0F, 0.0F, 2.5F};
-        cube.transform.scale = {0.5F, 0.5F, 0.5F};
+        m_scene.reserve(1 + m_settings.modelPaths.size() + m_settings.cubeCount);
 
-        m_gameObjects.push_back(std::move(cube));
+        TransformComponent cube{};
+        cube.translation = {0.0F, 0.0F, 2.5F};
+        cube.scale = {0.5F, 0.5F, 0.5F};
+        m_scene.createObject(model, cube);
+
+        const std::vector<std::filesystem::path> modelPaths{m_settings.modelPaths.begin(), m_settings.modelPaths.end()};
+        auto models{MeshLoader::loadModels(m_device, m_jobSystem, modelPaths)};
+
+        // Lined up to the right of the cube
+        for(std::size_t i{}; i < models.size(); ++i)
+        {
+            TransformComponent transform{};
+            transform.translation = {static_cast<float>(i + 1) * 1.5F, 0.0F, 2.5F};
+            transform.scale = {0.5F, 0.5F, 0.5F};
+
+            m_scene.createObject(std::move(models[i]), transform);
+        }
+
+        // A square grid on the ground plane in front of the camera, all sharing the cube model
+        const auto gridSize{static_cast<std::uint64_t>(std::ceil(std::sqrt(static_cast<double>(m_settings.cubeCount))))};
+        for(std::uint64_t i{}; i < m_settings.cubeCount; ++i)
+        {
+            TransformComponent transform{};
+            transform.translation = {(static_cast<float>(i % gridSize) - static_cast<float>(gridSize) * 0.5F) * 0.5F,
+                                     1.0F, 4.0F + static_cast<float>(i / gridSize) * 0.5F};
+            transform.rotation = {0.0F, static_cast<float>(i) * 0.1F, 0.0F};
+            transform.scale = glm::vec3{0.2F};
+
+            const float shade{static_cast<float>(i % 7) / 7.0F};
+            m_scene.createObject(model, transform, {0.5F + shade * 0.5F, 1.0F, 1.0F - shade * 0.5F});
+        }
     }
 
     void Application::run(void)
     {
         FrameTime frameTime{};
-        SimpleRenderSystem simpleRenderSystem{m_device, m_renderer.getSwapChainRenderPass()};
+        FrameLimiter frameLimiter{m_settings.fpsLimit};
+        GlobalUniforms globalUniforms{m_device, m_renderer.getFramesInFlight()};
+        PipelineRegistry pipelineRegistry{m_device};
+        SimpleRenderSystem simpleRenderSystem{m_device, m_jobSystem, pipelineRegistry,
+                                              m_renderer.getSwapChainRenderPass(), globalUniforms.getSetLayout()};
+        std::unique_ptr<GpuDrivenRenderSystem> gpuDrivenRenderSystem{};
+        if(m_settings.gpuCulling)
+        {
+            gpuDrivenRenderSystem = std::make_unique<GpuDrivenRenderSystem>(m_device, m_jobSystem, pipelineRegistry,
+                                                                            m_renderer.getSwapChainRenderPass(),
+                                                                            globalUniforms.getSetLayout());
+        }
+
+        // After everything it rebuilds, so its thread stops before they go away
+        std::unique_ptr<ShaderWatcher> shaderWatcher{};
+        if(m_settings.hotReload)
+        {
+            shaderWatcher = std::make_unique<ShaderWatcher>(m_device);
+            simpleRenderSystem.watchShaders(*shaderWatcher);
+            if(gpuDrivenRenderSystem)
+            {
+                gpuDrivenRenderSystem->watchShaders(*shaderWatcher);
+            }
+        }
+
+        // The swap chain render pass transitions the backbuffer itself, the graph only orders the passes around it.
+        // The depth buffer is the graph's, one image for all frames in flight that the barriers keep apart
+        RenderGraph renderGraph{m_device, m_renderer.getSwapChainExtent()};
+        const RenderGraph::ResourceHandle backbuffer{
+              renderGraph.importImage("backbuffer", m_renderer.getSwapChainImageFormat())};
+        VkClearValue depthClear{};
+        depthClear.depthStencil = {1.0F, 0};
+        const RenderGraph::ResourceHandle depth{
+              renderGraph.createImage("depth", {m_renderer.getSwapChainDepthFormat(), depthClear})};
+        const RenderGraph::ResourceHandle drawCommands{renderGraph.importBuffer("drawCommands")};
+        const RenderGraph::ResourceHandle visibleIds{renderGraph.importBuffer("visibleIds")};
+        renderGraph.markOutput(backbuffer);
+
+        if(gpuDrivenRenderSystem)
+        {
+            const RenderGraph::PassHandle cullPass{renderGraph.addPass(
+                  "gpuCulling", [&](FrameInfo& frameInfo) { gpuDrivenRenderSystem->cull(frameInfo); })};
+            renderGraph.write(cullPass, drawCommands, ResourceUsage::ComputeStorageWrite);
+            renderGraph.write(cullPass, visibleIds, ResourceUsage::ComputeStorageWrite);
+        }
+
+        const RenderGraph::PassHandle mainPass{renderGraph.addPass(
+              "main",
+              [&](FrameInfo& frameInfo)
+              {
+                  m_renderer.beginSwapChainRenderPass(frameInfo.commandBuffer, renderGraph.getImageView(depth));
+
+                  if(gpuDrivenRenderSystem)
+                  {
+                      gpuDrivenRenderSystem->render(frameInfo);
+                  }
+                  else
+                  {
+                      simpleRenderSystem.renderScene(frameInfo, m_scene);
+                  }
+
+                  m_renderer.endSwapChainRenderPass(frameInfo.commandBuffer);
+              })};
+        renderGraph.write(mainPass, backbuffer, ResourceUsage::ColorAttachment);
+        renderGraph.write(mainPass, depth, ResourceUsage::DepthAttachment);
+        if(gpuDrivenRenderSystem)
+        {
+            renderGraph.read(mainPass, drawCommands, ResourceUsage::IndirectRead);
+            renderGraph.read(mainPass, visibleIds, ResourceUsage::VertexStorageRead);
+        }
+        renderGraph.compile();
+
         Camera camera{};
         KeyboardMovementController cameraController{};
 
         auto cameraCurrentStat{GameObject::createGameObject()};
+        float elapsedTime{};
+
+        const std::uint64_t warmupFrames{m_settings.benchmark ? m_settings.warmupFrames : 0};
+        const std::uint64_t lastFrame{m_settings.maxFrames == 0 ? 0 : warmupFrames + m_settings.maxFrames};
+
+        FrameStatistics cpuFrameTimes{};
+        cpuFrameTimes.reserve(m_settings.maxFrames);
+
+        // How late the limiter released each frame, the pacing error on top of the frame time
+        FrameStatistics frameJitter{};
 
-        while(!m_window.shouldClose())
+        // GPU scopes by name, reported next to the CPU frame time
+        std::map<std::string, FrameStatistics> gpuTimes;
+
+        for(std::uint64_t frameCount{}; !m_window.shouldClose() && (lastFrame == 0 || frameCount < lastFrame);
+            ++frameCount)
         {
+            // Before the frame time is taken, so the limited rate is what it measures
+            const double lateness{frameLimiter.wait()};
+
             m_window.pollEvents();
             frameTime.gameLoopStarted();
 
-            cameraController.moveInPlaneXZ(m_window.getGLFWwindow(), frameTime.getFrameTime(), cameraCurrentStat);
+            // getFrameTime() holds the previous frame now, so frame "warmupFrames" is the first measured one
+            if(m_settings.benchmark && frameCount > warmupFrames)
+            {
+                cpuFrameTimes.record(static_cast<double>(frameTime.getFrameTime()) * 1000.0);
+
+                if(frameLimiter.isEnabled())
+                {
+                    frameJitter.record(lateness);
+                }
+            }
+
+            // There is no keyboard without a window
+            if(!m_window.isHeadless())
+            {
+                cameraController.moveInPlaneXZ(m_window.getGLFWwindow(), frameTime.getFrameTime(), cameraCurrentStat);
+            }
             camera.setViewYXZ(cameraCurrentStat.transform.translation, cameraCurrentStat.transform.rotation);
 
             camera.setPerspectiveProjection(glm::radians(50.0F), m_renderer.getSwapChainAspectRatio(), 0.1F, 100.0F);
+            elapsedTime += frameTime.getFrameTime();
+
+            m_scene.updateWorldMatrices(m_jobSystem);
+
+            // Between two frames nothing is recording with the pipelines being replaced
+            if(shaderWatcher)
+            {
+                shaderWatcher->applyReloads(m_renderer.getFrameNumber() - 1);
+            }
 
             if(VkCommandBuffer commandBuffer{m_renderer.beginFrame()})
             {
-                m_renderer.beginSwapChainRenderPass(commandBuffer);
+                // beginFrame() may have recreated the swap chain
+                renderGraph.resize(m_renderer.getSwapChainExtent(), m_renderer.getFrameNumber() - 1);
 
-                simpleRenderSystem.renderGameObjects(commandBuffer, m_gameObjects, camera);
+                const std::uint32_t frameIndex{m_renderer.getFrameIndex()};
 
-                m_renderer.endSwapChainRenderPass(commandBuffer);
+                FrameInfo frameInfo{frameIndex,
+                                    frameTime.getFrameTime(),
+                                    commandBuffer,
+                                    camera,
+                                    globalUniforms.getDescriptorSet(frameIndex),
+                                    m_renderer.getGpuProfiler(),
+                                    m_renderer.getCommandRecorder(),
+                                    m_renderer.getFrameArena()};
+
+                // Once per frame instead of once per object
+                GlobalUbo ubo{};
+                ubo.projection = camera.getProjection();
+                ubo.view = camera.getView();
+                ubo.projectionView = camera.getProjection() * camera.getView();
+                ubo.time = elapsedTime;
+                ubo.frameTime = frameTime.getFrameTime();
+                ubo.frameIndex = frameIndex;
+                globalUniforms.update(frameIndex, ubo);
+
+                // These are the timings of the frame that used this frame index last time
+                if(m_settings.benchmark && frameCount > warmupFrames)
+                {
+                    for(const auto& timing : frameInfo.gpuProfiler.getResults())
+                    {
+                        gpuTimes[timing.name].record(timing.milliseconds);
+                    }
+                }
+
+                // Before the graph sees the buffers, the update can replace them
+                if(gpuDrivenRenderSystem)
+                {
+                    gpuDrivenRenderSystem->update(frameInfo, m_scene);
+                    renderGraph.setBuffer(drawCommands, gpuDrivenRenderSystem->getDrawCommandBuffer(frameIndex));
+                    renderGraph.setBuffer(visibleIds, gpuDrivenRenderSystem->getVisibleBuffer(frameIndex));
+                }
+
+                renderGraph.execute(frameInfo);
                 m_renderer.endFrame();
             }
 
-            performance(frameTime.getFrameTime());
+            if(!m_settings.benchmark)
+            {
+                performance(frameTime.getFrameTime());
+            }
+        }
+
+        if(m_settings.benchmark)
+        {
+            // Close the last measured frame before vkDeviceWaitIdle adds the queue drain to it
+            frameTime.gameLoopStarted();
+            if(cpuFrameTimes.count() < m_settings.maxFrames)
+            {
+                cpuFrameTimes.record(static_cast<double>(frameTime.getFrameTime()) * 1000.0);
+            }
         }
 
         vkDeviceWaitIdle(m_device.device());
+
+        if(m_settings.benchmark)
+        {
+            std::map<std::string, FrameStatistics> series{std::move(gpuTimes)};
+            series.emplace("cpuFrame", std::move(cpuFrameTimes));
+            if(frameLimiter.isEnabled())
+            {
+                series.emplace("frameJitter", std::move(frameJitter));
+            }
+
+            FrameStatistics::writeReport(m_settings.reportPath, m_settings.reportFormat, warmupFrames, series);
+
+            const FrameTimeSummary summary{series["cpuFrame"].summarize()};
+            std::cout << "Benchmark: " << summary.count << " frames, mean " << summary.mean << " ms, p99 "
+                      << summary.p99 << " ms";
+
+            if(series.contains("gpuFrame"))
+            {
+                std::cout << ", GPU mean " << series["gpuFrame"].summarize().mean << " ms";
+            }
+            std::cout << ", written to " << m_settings.reportPath << '\n';
+
+            const MemoryStatistics memory{m_device.allocator().getStatistics()};
+            std::cout << "Device memory: " << memory.deviceMemoryCount << " memory objects, " << memory.blockCount
+                      << " blocks, " << memory.allocationCount << " allocations (" << memory.dedicatedAllocationCount
+                      << " dedicated), " << memory.usedBytes << '/' << memory.reservedBytes
+                      << " block bytes used, fragmentation " << memory.fragmentation << '\n';
+
+            const PipelineRegistryStatistics pipelines{pipelineRegistry.getStatistics()};
+            std::cout << "Pipelines: " << pipelines.pipelineCount << " live, " << pipelines.hitCount << " hits, "
+                      << pipelines.missCount << " misses\n";
+        }
     }
 
     void Application::performance(float frameTime, bool inSeconds)
@@ -1,8 +1,12 @@
 #include "Device.h"
+#include "StagingRing.h"
 
 // std
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <unordered_set>
 #include <vector>
@@ -61,9 +65,16 @@ namespace VE
           m_surface{},
           m_graphicsQueue{},
           m_presentQueue{},
+          m_transferQueue{},
+          m_computeQueue{},
+          m_transferFamily{},
+          m_computeFamily{},
           m_validationLayers{"VK_LAYER_KHRONOS_validation"},
-          m_deviceExtensions{VK_KHR_SWAPCHAIN_EXTENSION_NAME},
-          m_properties{}
+          m_deviceExtensions{window.isHeadless() ? std::vector<const char*>{}
+                                                 : std::vector<const char*>{VK_KHR_SWAPCHAIN_EXTENSION_NAME}},
+          m_properties{},
+          m_pipelineCache{},
+          m_frameTimeline{}
     {
         createInstance();
         setupDebugMessenger();
@@ -71,10 +82,31 @@ namespace VE
         pickPhysicalDevice();
         createLogicalDevice();
         createCommandPool();
+        createPipelineCache();
+        createFrameTimeline();
+
+        m_allocator = std::make_unique<MemoryAllocator>(m_device, m_physicalDevice);
+        m_stagingRing = std::make_unique<StagingRing>(*this);
     }
 
     Device::~Device(void)
     {
+        m_stagingRing.reset();
+        m_allocator.reset();
+
+        // A lost cache only costs the next start its warm pipelines, never fail the shutdown for it
+        try
+        {
+            savePipelineCache();
+        }
+        catch(const std::exception& exception)
+        {
+            std::cerr << exception.what() << '\n';
+        }
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+
+        vkDestroySemaphore(m_device, m_frameTimeline, nullptr);
+
         vkDestroyCommandPool(m_device, m_commandPool, nullptr);
         vkDestroyDevice(m_device, nullptr);
 
@@ -83,7 +115,10 @@ namespace VE
             DestroyDebugUtilsMessengerEXT(m_instance, m_debugMessenger, nullptr);
         }
 
-        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+        if(m_surface)
+        {
+            vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+        }
         vkDestroyInstance(m_instance, nullptr);
     }
 
@@ -150,8 +185,21 @@ namespace VE
         std::vector<VkPhysicalDevice> devices(deviceCount);
         vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
 
+        bool foundOlderDevice{};
         for(const auto& device : devices)
         {
+            // Older devices can't even be asked for the 1.2 features isDeviceSuitable() needs
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(device, &properties);
+            if(properties.apiVersion < MIN_API_VERSION)
+            {
+                std::cout << "Skipping " << static_cast<char*>(properties.deviceName) << ", it only supports Vulkan "
+                          << VK_API_VERSION_MAJOR(properties.apiVersion) << '.'
+                          << VK_API_VERSION_MINOR(properties.apiVersion) << '\n';
+                foundOlderDevice = true;
+                continue;
+            }
+
             if(isDeviceSuitable(device))
             {
                 m_physicalDevice = device;
@@ -161,6 +209,10 @@ namespace VE
 
         if(m_physicalDevice == VK_NULL_HANDLE)
         {
+            if(foundOlderDevice)
+            {
+                throw std::runtime_error{"Failed to find a suitable GPU, Vulkan 1.2 or newer is required!"};
+            }
             throw std::runtime_error{"Failed to find a suitable GPU!"};
         }
 
@@ -173,7 +225,14 @@ namespace VE
         QueueFamilyIndices indices{findQueueFamilies(m_physicalDevice)};
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<std::uint32_t> uniqueQueueFamilies{indices.graphicsFamily.value(), indices.presentFamily.value()};
+        std::set<std::uint32_t> uniqueQueueFamilies{indices.graphicsFamily.value()};
+        for(const auto& family : {indices.presentFamily, indices.transferFamily, indices.computeFamily})
+        {
+            if(family.has_value())
+            {
+                uniqueQueueFamilies.insert(family.value());
+            }
+        }
 
         // Don't think you are smart and put it outside
         float queuePriority{};
@@ -191,8 +250,14 @@ namespace VE
         VkPhysicalDeviceFeatures deviceFeatures{};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+        // Core since 1.2, pickPhysicalDevice() checked the version and isDeviceSuitable() the feature
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.timelineSemaphore = VK_TRUE;
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = &vulkan12Features;
 
         createInfo.queueCreateInfoCount = static_cast<std::uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -219,7 +284,57 @@ namespace VE
         }
 
         vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
-        vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+        if(indices.presentFamily.has_value())
+        {
+            vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+        }
+
+        // Graphics families always do transfer and compute too, so falling back costs nothing but the overlap
+        m_transferFamily = indices.transferFamily.value_or(indices.graphicsFamily.value());
+        m_computeFamily = indices.computeFamily.value_or(indices.graphicsFamily.value());
+        vkGetDeviceQueue(m_device, m_transferFamily, 0, &m_transferQueue);
+        vkGetDeviceQueue(m_device, m_computeFamily, 0, &m_computeQueue);
+    }
+
+    void Device::createFrameTimeline(void)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+
+        if(vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_frameTimeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create frame timeline semaphore!"};
+        }
+    }
+
+    std::uint64_t Device::getCompletedFrame(void)
+    {
+        std::uint64_t value{};
+        if(vkGetSemaphoreCounterValue(m_device, m_frameTimeline, &value) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to read the frame timeline semaphore!"};
+        }
+        return value;
+    }
+
+    void Device::waitForFrame(std::uint64_t frameNumber)
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_frameTimeline;
+        waitInfo.pValues = &frameNumber;
+
+        if(vkWaitSemaphores(m_device, &waitInfo, std::numeric_limits<std::uint64_t>::max()) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to wait for the frame timeline semaphore!"};
+        }
     }
 
     void Device::createCommandPool(void)
@@ -237,7 +352,96 @@ namespace VE
         }
     }
 
-    void Device::createSurface(void) { m_window.createWindowSurface(m_instance, &m_surface); }
+    void Device::createPipelineCache(void)
+    {
+        std::vector<char> cacheData;
+
+        std::ifstream file{PIPELINE_CACHE_PATH, std::ios::binary | std::ios::ate};
+        if(file)
+        {
+            cacheData.resize(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(cacheData.data(), static_cast<std::streamsize>(cacheData.size()));
+
+            // Drivers are supposed to reject foreign data themselves, not all of them do it gracefully
+            if(!file || !isPipelineCacheCompatible(cacheData))
+            {
+                cacheData.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = cacheData.size();
+        cacheInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+        if(vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create pipeline cache!"};
+        }
+    }
+
+    bool Device::isPipelineCacheCompatible(const std::vector<char>& cacheData) const
+    {
+        VkPipelineCacheHeaderVersionOne header{};
+        if(cacheData.size() < sizeof(header))
+        {
+            return false;
+        }
+        std::memcpy(&header, cacheData.data(), sizeof(header));
+
+        return header.headerSize >= sizeof(header) && header.headerSize <= cacheData.size() &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == m_properties.vendorID && header.deviceID == m_properties.deviceID &&
+               std::memcmp(header.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void Device::savePipelineCache(void)
+    {
+        std::size_t dataSize{};
+        if(vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to get pipeline cache data size!"};
+        }
+
+        std::vector<char> cacheData(dataSize);
+        if(vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, cacheData.data()) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to get pipeline cache data!"};
+        }
+        cacheData.resize(dataSize);
+
+        // Written next to the old one and renamed over it, a crash never leaves half a cache behind
+        const std::filesystem::path cachePath{PIPELINE_CACHE_PATH};
+        std::filesystem::path tempPath{cachePath};
+        tempPath += ".tmp";
+
+        {
+            std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+            file.write(cacheData.data(), static_cast<std::streamsize>(cacheData.size()));
+            file.flush();
+
+            if(!file)
+            {
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+                throw std::runtime_error{"Failed to write pipeline cache " + tempPath.string() + "!"};
+            }
+        }
+
+        std::filesystem::rename(tempPath, cachePath);
+    }
+
+    void Device::createSurface(void)
+    {
+        // Headless devices render into offscreen images, there is nothing to present to
+        if(isHeadless())
+        {
+            return;
+        }
+
+        m_window.createWindowSurface(m_instance, &m_surface);
+    }
 
     bool Device::isDeviceSuitable(VkPhysicalDevice phyDevice)
     {
@@ -245,17 +449,24 @@ namespace VE
 
         bool extensionsSupported{checkDeviceExtensionSupport(phyDevice)};
 
-        bool swapChainAdequate{};
-        if(extensionsSupported)
+        // Present support is only needed when we have a surface
+        bool swapChainAdequate{isHeadless()};
+        if(extensionsSupported && !isHeadless())
         {
             SwapChainSupportDetails swapChainSupport{querySwapChainSupport(phyDevice)};
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
 
-        VkPhysicalDeviceFeatures supportedFeatures;
-        vkGetPhysicalDeviceFeatures(phyDevice, &supportedFeatures);
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
-        return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+        VkPhysicalDeviceFeatures2 supportedFeatures{};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures.pNext = &vulkan12Features;
+        vkGetPhysicalDeviceFeatures2(phyDevice, &supportedFeatures);
+
+        return indices.isComplete(!isHeadless()) && extensionsSupported && swapChainAdequate &&
+              supportedFeatures.features.samplerAnisotropy && vulkan12Features.timelineSemaphore;
     }
 
     void Device::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo)
@@ -315,7 +526,7 @@ namespace VE
 
     std::vector<const char*> Device::getRequiredExtensions(void) const
     {
-        std::vector<const char*> extensions{Window::getInstanceExtensions()};
+        std::vector<const char*> extensions{m_window.getInstanceExtensions()};
 
         if(m_enableValidationLayers)
         {
@@ -383,21 +594,41 @@ namespace VE
 
         for(std::uint32_t familyIndex{}; const auto& queueFamily : queueFamilies)
         {
-            if(queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            if(queueFamily.queueCount == 0)
+            {
+                ++familyIndex;
+                continue;
+            }
+
+            const bool graphics{(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0};
+            const bool compute{(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0};
+            const bool transfer{(queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0};
+
+            if(graphics && !indices.graphicsFamily.has_value())
             {
                 indices.graphicsFamily = familyIndex;
             }
 
             VkBool32 presentSupport{};
-            vkGetPhysicalDeviceSurfaceSupportKHR(phyDevice, familyIndex, m_surface, &presentSupport);
-            if(queueFamily.queueCount > 0 && presentSupport)
+            if(!isHeadless())
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(phyDevice, familyIndex, m_surface, &presentSupport);
+            }
+
+            if(presentSupport && !indices.presentFamily.has_value())
             {
                 indices.presentFamily = familyIndex;
             }
 
-            if(indices.isComplete())
+            // A pure copy engine beats a compute family that can also copy
+            if(transfer && !graphics && (!indices.transferFamily.has_value() || !compute))
             {
-                break;
+                indices.transferFamily = familyIndex;
+            }
+
+            if(compute && !graphics && !indices.computeFamily.has_value())
+            {
+                indices.computeFamily = familyIndex;
             }
 
             ++familyIndex;
@@ -406,6 +637,22 @@ namespace VE
         return indices;
     }
 
+    VkQueueFamilyProperties Device::getQueueFamilyProperties(std::uint32_t familyIndex)
+    {
+        std::uint32_t queueFamilyCount{};
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+        if(familyIndex >= queueFamilyCount)
+        {
+            throw std::runtime_error{"Queue family index out of range!"};
+        }
+
+        return queueFamilies[familyIndex];
+    }
+
     SwapChainSupportDetails Device::querySwapChainSupport(VkPhysicalDevice phyDevice)
     {
         SwapChainSupportDetails details;
@@ -470,7 +717,7 @@ namespace VE
                               VkBufferUsageFlags usage,
                               VkMemoryPropertyFlags properties,
                               VkBuffer& buffer,
-                              VkDeviceMemory& bufferMemory)
+                              Allocation& bufferAllocation)
     {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -486,17 +733,30 @@ namespace VE
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(m_device, buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+        // The buffer doesn't outlive a failed allocation or bind
+        try
+        {
+            bufferAllocation = m_allocator->allocate(memRequirements, properties, ResourceKind::Linear);
+        }
+        catch(...)
+        {
+            vkDestroyBuffer(m_device, buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
+            throw;
+        }
 
-        if(vkAllocateMemory(m_device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+        if(vkBindBufferMemory(m_device, buffer, bufferAllocation.memory, bufferAllocation.offset) != VK_SUCCESS)
         {
-            throw std::runtime_error{"Failed to allocate vertex buffer memory!"};
+            destroyBuffer(buffer, bufferAllocation);
+            throw std::runtime_error{"Failed to bind buffer memory!"};
         }
+    }
 
-        vkBindBufferMemory(m_device, buffer, bufferMemory, 0);
+    void Device::destroyBuffer(VkBuffer& buffer, Allocation& bufferAllocation)
+    {
+        vkDestroyBuffer(m_device, buffer, nullptr);
+        m_allocator->free(bufferAllocation);
+        buffer = VK_NULL_HANDLE;
     }
 
     VkCommandBuffer Device::beginSingleTimeCommands(void)
@@ -571,7 +831,7 @@ namespace VE
     void Device::createImageWithInfo(const VkImageCreateInfo& imageInfo,
                                      VkMemoryPropertyFlags properties,
                                      VkImage& image,
-                                     VkDeviceMemory& imageMemory)
+                                     Allocation& imageAllocation)
     {
         if(vkCreateImage(m_device, &imageInfo, nullptr, &image) != VK_SUCCESS)
         {
@@ -581,19 +841,31 @@ namespace VE
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(m_device, image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if(vkAllocateMemory(m_device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+        const ResourceKind kind{imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal
+                                                                            : ResourceKind::Linear};
+        // The image doesn't outlive a failed allocation or bind
+        try
+        {
+            imageAllocation = m_allocator->allocate(memRequirements, properties, kind);
+        }
+        catch(...)
         {
-            throw std::runtime_error{"Failed to allocate image memory!"};
+            vkDestroyImage(m_device, image, nullptr);
+            image = VK_NULL_HANDLE;
+            throw;
         }
 
-        if(vkBindImageMemory(m_device, image, imageMemory, 0) != VK_SUCCESS)
+        if(vkBindImageMemory(m_device, image, imageAllocation.memory, imageAllocation.offset) != VK_SUCCESS)
         {
+            destroyImage(image, imageAllocation);
             throw std::runtime_error{"Failed to bind image memory!"};
         }
     }
+
+    void Device::destroyImage(VkImage& image, Allocation& imageAllocation)
+    {
+        vkDestroyImage(m_device, image, nullptr);
+        m_allocator->free(imageAllocation);
+        image = VK_NULL_HANDLE;
+    }
 }
@@ -0,0 +1,80 @@
+#include "FrameArena.h"
+
+// std
+#include <algorithm>
+#include <cstdint>
+
+namespace VE
+{
+    // Constructor
+    FrameArena::FrameArena(std::size_t capacity)
+        : m_block{std::make_unique_for_overwrite<std::byte[]>(capacity)},
+          m_capacity{capacity},
+          m_used{},
+          m_overflowBytes{}
+    {
+    }
+
+    void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        const auto base{reinterpret_cast<std::uintptr_t>(m_block.get())};
+        std::size_t used{m_used.load(std::memory_order_relaxed)};
+
+        for(;;)
+        {
+            // Alignment is always a power of two
+            const std::uintptr_t aligned{(base + used + alignment - 1) & ~(std::uintptr_t{alignment} - 1)};
+            const std::size_t end{static_cast<std::size_t>(aligned - base) + bytes};
+
+            if(end > m_capacity)
+            {
+                return allocateOverflow(bytes, alignment);
+            }
+
+            if(m_used.compare_exchange_weak(used, end, std::memory_order_relaxed))
+            {
+                return reinterpret_cast<void*>(aligned);
+            }
+        }
+    }
+
+    void* FrameArena::allocateOverflow(std::size_t bytes, std::size_t alignment)
+    {
+        std::lock_guard<std::mutex> lock{m_overflowMutex};
+
+        auto block{std::make_unique_for_overwrite<std::byte[]>(bytes + alignment)};
+        void* pointer{block.get()};
+        std::size_t space{bytes + alignment};
+        std::align(alignment, bytes, pointer, space);
+
+        m_overflowBlocks.push_back(std::move(block));
+        m_overflowBytes += bytes + alignment;
+
+        return pointer;
+    }
+
+    void FrameArena::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment)
+    {
+        // Released all at once in reset()
+        static_cast<void>(pointer);
+        static_cast<void>(bytes);
+        static_cast<void>(alignment);
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept { return this == &other; }
+
+    void FrameArena::reset(void)
+    {
+        if(!m_overflowBlocks.empty())
+        {
+            // The only heap traffic, once per new high water mark
+            m_capacity = std::max(m_capacity * 2, m_used.load(std::memory_order_relaxed) + m_overflowBytes);
+            m_block = std::make_unique_for_overwrite<std::byte[]>(m_capacity);
+
+            m_overflowBlocks.clear();
+            m_overflowBytes = 0;
+        }
+
+        m_used.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,48 @@
+#include "FrameLimiter.h"
+
+// std
+#include <thread>
+
+namespace VE
+{
+    // Constructor
+    FrameLimiter::FrameLimiter(double framesPerSecond)
+        : m_period{framesPerSecond > 0.0 ? std::chrono::duration_cast<Clock::duration>(
+                                                 std::chrono::duration<double>{1.0 / framesPerSecond})
+                                           : Clock::duration::zero()},
+          m_deadline{Clock::now()}
+    {
+    }
+
+    double FrameLimiter::wait(void)
+    {
+        if(!isEnabled())
+        {
+            return 0.0;
+        }
+
+        m_deadline += m_period;
+        Clock::time_point now{Clock::now()};
+
+        // More than a whole frame behind, e.g. after a hitch or a resize. Start over instead of racing to catch up,
+        // but still report how late the frame was
+        if(now - m_deadline > m_period)
+        {
+            const double lateness{std::chrono::duration<double, std::milli>{now - m_deadline}.count()};
+            m_deadline = now;
+            return lateness;
+        }
+
+        if(m_deadline - now > SPIN_THRESHOLD)
+        {
+            std::this_thread::sleep_until(m_deadline - SPIN_THRESHOLD);
+        }
+
+        do
+        {
+            now = Clock::now();
+        } while(now < m_deadline);
+
+        return std::chrono::duration<double, std::milli>{now - m_deadline}.count();
+    }
+}
@@ -0,0 +1,123 @@
+#include "FrameStatistics.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace VE
+{
+    double FrameStatistics::percentile(const std::vector<double>& sorted, double fraction)
+    {
+        const double rank{fraction * static_cast<double>(sorted.size() - 1)};
+        const auto lower{static_cast<std::size_t>(std::floor(rank))};
+        const std::size_t upper{std::min(lower + 1, sorted.size() - 1)};
+
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+    }
+
+    [[nodiscard]] FrameTimeSummary FrameStatistics::summarize(void) const
+    {
+        FrameTimeSummary summary{};
+        summary.count = m_samples.size();
+
+        if(m_samples.empty())
+        {
+            return summary;
+        }
+
+        std::vector<double> sorted{m_samples};
+        std::sort(sorted.begin(), sorted.end());
+
+        summary.min = sorted.front();
+        summary.max = sorted.back();
+        summary.p50 = percentile(sorted, 0.50);
+        summary.p95 = percentile(sorted, 0.95);
+        summary.p99 = percentile(sorted, 0.99);
+
+        // Welford, summing the squares directly loses everything to cancellation
+        double mean{};
+        double squaredDistance{};
+        for(std::size_t sampleIndex{}; sampleIndex < m_samples.size(); ++sampleIndex)
+        {
+            const double delta{m_samples[sampleIndex] - mean};
+            mean += delta / static_cast<double>(sampleIndex + 1);
+            squaredDistance += delta * (m_samples[sampleIndex] - mean);
+        }
+
+        summary.mean = mean;
+
+        // Sample variance
+        summary.variance = m_samples.size() > 1 ? squaredDistance / static_cast<double>(m_samples.size() - 1) : 0.0;
+
+        return summary;
+    }
+
+    void FrameStatistics::writeReport(const std::string& filePath,
+                                      ReportFormat format,
+                                      std::uint64_t warmupFrames,
+                                      const std::map<std::string, FrameStatistics>& series)
+    {
+        std::ofstream file{filePath, std::ios::out | std::ios::trunc};
+
+        if(!file.is_open())
+        {
+            throw std::runtime_error{"Failed to open benchmark report(" + filePath + ")!"};
+        }
+
+        file << std::fixed << std::setprecision(6);
+
+        if(format == ReportFormat::Csv)
+        {
+            file << "series,warmup_frames,frames,min_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,variance_ms2\n";
+
+            for(const auto& [name, statistics] : series)
+            {
+                const FrameTimeSummary summary{statistics.summarize()};
+
+                file << name << ',' << warmupFrames << ',' << summary.count << ',' << summary.min << ','
+                     << summary.mean << ',' << summary.p50 << ',' << summary.p95 << ',' << summary.p99 << ','
+                     << summary.max << ',' << summary.variance << '\n';
+            }
+        }
+        else
+        {
+            file << "{\n  \"warmupFrames\": " << warmupFrames << ",\n  \"series\": {";
+
+            bool firstSeries{true};
+            for(const auto& [name, statistics] : series)
+            {
+                const FrameTimeSummary summary{statistics.summarize()};
+
+                file << (firstSeries ? "\n" : ",\n");
+                file << "    \"" << name << "\": {\n"
+                     << "      \"frames\": " << summary.count << ",\n"
+                     << "      \"minMs\": " << summary.min << ",\n"
+                     << "      \"meanMs\": " << summary.mean << ",\n"
+                     << "      \"p50Ms\": " << summary.p50 << ",\n"
+                     << "      \"p95Ms\": " << summary.p95 << ",\n"
+                     << "      \"p99Ms\": " << summary.p99 << ",\n"
+                     << "      \"maxMs\": " << summary.max << ",\n"
+                     << "      \"varianceMs2\": " << summary.variance << ",\n"
+                     << "      \"samplesMs\": [";
+
+                for(std::size_t sampleIndex{}; sampleIndex < statistics.samples().size(); ++sampleIndex)
+                {
+                    file << (sampleIndex ? ", " : "") << statistics.samples()[sampleIndex];
+                }
+
+                file << "]\n    }";
+                firstSeries = false;
+            }
+
+            file << "\n  }\n}\n";
+        }
+
+        if(!file)
+        {
+            throw std::runtime_error{"Failed to write benchmark report(" + filePath + ")!"};
+        }
+    }
+}
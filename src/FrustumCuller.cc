@@ -0,0 +1,173 @@
+#include "FrustumCuller.h"
+
+// std
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+// SIMD
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace VE
+{
+    void SphereBatch::clear(void)
+    {
+        centerX.clear();
+        centerY.clear();
+        centerZ.clear();
+        radius.clear();
+    }
+
+    void SphereBatch::resize(std::size_t count)
+    {
+        centerX.resize(count);
+        centerY.resize(count);
+        centerZ.resize(count);
+        radius.resize(count);
+    }
+
+    void SphereBatch::set(std::size_t index, const BoundingSphere& sphere)
+    {
+        centerX[index] = sphere.center.x;
+        centerY[index] = sphere.center.y;
+        centerZ[index] = sphere.center.z;
+        radius[index] = sphere.radius;
+    }
+
+    void SphereBatch::push(const BoundingSphere& sphere)
+    {
+        centerX.push_back(sphere.center.x);
+        centerY.push_back(sphere.center.y);
+        centerZ.push_back(sphere.center.z);
+        radius.push_back(sphere.radius);
+    }
+
+    void FrustumCuller::setViewProjection(const glm::mat4& projectionView)
+    {
+        // glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const auto row{[&projectionView](int i)
+                       {
+                           return glm::vec4{projectionView[0][i], projectionView[1][i], projectionView[2][i],
+                                            projectionView[3][i]};
+                       }};
+
+        // Clip space is -w <= x, y <= w and 0 <= z <= w
+        const std::array<glm::vec4, PLANE_COUNT> planes{
+              row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2)};
+
+        for(std::size_t i{}; i < PLANE_COUNT; ++i)
+        {
+            const float length{std::sqrt(planes[i].x * planes[i].x + planes[i].y * planes[i].y +
+                                         planes[i].z * planes[i].z)};
+
+            m_planeX[i] = planes[i].x / length;
+            m_planeY[i] = planes[i].y / length;
+            m_planeZ[i] = planes[i].z / length;
+            m_planeW[i] = planes[i].w / length;
+        }
+    }
+
+    bool FrustumCuller::isVisible(const BoundingSphere& sphere) const
+    {
+        for(std::size_t i{}; i < PLANE_COUNT; ++i)
+        {
+            const float distance{m_planeX[i] * sphere.center.x + m_planeY[i] * sphere.center.y +
+                                 m_planeZ[i] * sphere.center.z + m_planeW[i]};
+            if(distance < -sphere.radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t FrustumCuller::cull(const SphereBatch& spheres, std::span<std::uint32_t> visible) const
+    {
+        return cull(spheres, 0, spheres.size(), visible);
+    }
+
+    std::size_t FrustumCuller::cull(const SphereBatch& spheres,
+                                    std::size_t first,
+                                    std::size_t last,
+                                    std::span<std::uint32_t> visible) const
+    {
+        if(last < first || last > spheres.size() || visible.size() < last - first)
+        {
+            throw std::runtime_error{"Culling range doesn't fit the spheres or the visible indices!"};
+        }
+
+        std::size_t count{};
+
+#if defined(__AVX__)
+        for(; first + 8 <= last; first += 8)
+        {
+            const __m256 x{_mm256_loadu_ps(spheres.centerX.data() + first)};
+            const __m256 y{_mm256_loadu_ps(spheres.centerY.data() + first)};
+            const __m256 z{_mm256_loadu_ps(spheres.centerZ.data() + first)};
+            const __m256 negativeRadius{
+                  _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius.data() + first))};
+
+            __m256 inside{_mm256_castsi256_ps(_mm256_set1_epi32(-1))};
+            for(std::size_t i{}; i < PLANE_COUNT; ++i)
+            {
+                __m256 distance{_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(m_planeX[i])),
+                                              _mm256_set1_ps(m_planeW[i]))};
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(m_planeY[i])));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(m_planeZ[i])));
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+            }
+
+            for(int mask{_mm256_movemask_ps(inside)}; mask; mask &= mask - 1)
+            {
+                visible[count++] = static_cast<std::uint32_t>(first) +
+                                   static_cast<std::uint32_t>(std::countr_zero(static_cast<unsigned>(mask)));
+            }
+        }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+        for(; first + 4 <= last; first += 4)
+        {
+            const __m128 x{_mm_loadu_ps(spheres.centerX.data() + first)};
+            const __m128 y{_mm_loadu_ps(spheres.centerY.data() + first)};
+            const __m128 z{_mm_loadu_ps(spheres.centerZ.data() + first)};
+            const __m128 negativeRadius{_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius.data() + first))};
+
+            __m128 inside{_mm_castsi128_ps(_mm_set1_epi32(-1))};
+            for(std::size_t i{}; i < PLANE_COUNT; ++i)
+            {
+                __m128 distance{_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m_planeX[i])), _mm_set1_ps(m_planeW[i]))};
+                distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(m_planeY[i])));
+                distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(m_planeZ[i])));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+            }
+
+            const int mask{_mm_movemask_ps(inside)};
+            for(std::uint32_t lane{}; lane < 4; ++lane)
+            {
+                if(mask & (1 << lane))
+                {
+                    visible[count++] = static_cast<std::uint32_t>(first) + lane;
+                }
+            }
+        }
+#endif
+
+        // Whatever doesn't fill a whole register, or everything on other architectures
+        for(; first < last; ++first)
+        {
+            const BoundingSphere sphere{{spheres.centerX[first], spheres.centerY[first], spheres.centerZ[first]},
+                                        spheres.radius[first]};
+            if(isVisible(sphere))
+            {
+                visible[count++] = static_cast<std::uint32_t>(first);
+            }
+        }
+
+        return count;
+    }
+}
@@ -10,20 +10,33 @@ namespace VE
 
     [[nodiscard]] glm::mat4 TransformComponent::mat4(void) const
     {
-        glm::mat4 transform{glm::translate(glm::mat4{1.0F}, translation)};
+        // translate * rotateY * rotateX * rotateZ * scale multiplied out, Tait-Bryan angles Y(1), X(2), Z(3)
+        const float c3{glm::cos(rotation.z)};
+        const float s3{glm::sin(rotation.z)};
+        const float c2{glm::cos(rotation.x)};
+        const float s2{glm::sin(rotation.x)};
+        const float c1{glm::cos(rotation.y)};
+        const float s1{glm::sin(rotation.y)};
 
-        // rotate y
-        transform = glm::rotate(transform, rotation.y, glm::vec3{0.0F, 1.0F, 0.0F});
-
-        // rotate x
-        transform = glm::rotate(transform, rotation.x, glm::vec3{1.0F, 0.0F, 0.0F});
-
-        // rotate z
-        transform = glm::rotate(transform, rotation.z, glm::vec3{0.0F, 0.0F, 1.0F});
-
-        // scale
-        transform = glm::scale(transform, scale);
-
-        return transform;
+        return glm::mat4{
+              {
+                    scale.x * (c1 * c3 + s1 * s2 * s3),
+                    scale.x * (c2 * s3),
+                    scale.x * (c1 * s2 * s3 - c3 * s1),
+                    0.0F,
+              },
+              {
+                    scale.y * (c3 * s1 * s2 - c1 * s3),
+                    scale.y * (c2 * c3),
+                    scale.y * (c1 * c3 * s2 + s1 * s3),
+                    0.0F,
+              },
+              {
+                    scale.z * (c2 * s1),
+                    scale.z * (-s2),
+                    scale.z * (c1 * c2),
+                    0.0F,
+              },
+              {translation.x, translation.y, translation.z, 1.0F}};
     }
 }
@@ -0,0 +1,113 @@
+#include "GlobalUniforms.h"
+
+// std
+#include <cstring>
+#include <stdexcept>
+
+namespace VE
+{
+    // Constructor
+    GlobalUniforms::GlobalUniforms(Device& device, std::uint32_t framesInFlight)
+        : m_device{device}, m_setLayout{}, m_descriptorPool{}, m_frames(framesInFlight)
+    {
+        createSetLayout();
+        createDescriptorPool();
+        createFrameUniforms();
+    }
+
+    // Destructor
+    GlobalUniforms::~GlobalUniforms(void)
+    {
+        for(auto& frame : m_frames)
+        {
+            m_device.destroyBuffer(frame.buffer, frame.allocation);
+        }
+
+        // Frees the descriptor sets along with it
+        vkDestroyDescriptorPool(m_device.device(), m_descriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device.device(), m_setLayout, nullptr);
+    }
+
+    void GlobalUniforms::createSetLayout(void)
+    {
+        VkDescriptorSetLayoutBinding uboBinding{};
+        uboBinding.binding = 0;
+        uboBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboBinding.descriptorCount = 1;
+        uboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &uboBinding;
+
+        if(vkCreateDescriptorSetLayout(m_device.device(), &layoutInfo, nullptr, &m_setLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create global descriptor set layout!"};
+        }
+    }
+
+    void GlobalUniforms::createDescriptorPool(void)
+    {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSize.descriptorCount = static_cast<std::uint32_t>(m_frames.size());
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = static_cast<std::uint32_t>(m_frames.size());
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        if(vkCreateDescriptorPool(m_device.device(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create global descriptor pool!"};
+        }
+    }
+
+    void GlobalUniforms::createFrameUniforms(void)
+    {
+        const std::vector<VkDescriptorSetLayout> setLayouts(m_frames.size(), m_setLayout);
+        std::vector<VkDescriptorSet> descriptorSets(m_frames.size());
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_descriptorPool;
+        allocInfo.descriptorSetCount = static_cast<std::uint32_t>(setLayouts.size());
+        allocInfo.pSetLayouts = setLayouts.data();
+
+        if(vkAllocateDescriptorSets(m_device.device(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to allocate global descriptor sets!"};
+        }
+
+        for(std::size_t frame{}; frame < m_frames.size(); ++frame)
+        {
+            // Written once per frame by the CPU and read by a few draws, mapped memory is the cheapest path
+            m_device.createBuffer(sizeof(GlobalUbo), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                  m_frames[frame].buffer, m_frames[frame].allocation);
+            m_frames[frame].descriptorSet = descriptorSets[frame];
+
+            VkDescriptorBufferInfo bufferInfo{};
+            bufferInfo.buffer = m_frames[frame].buffer;
+            bufferInfo.offset = 0;
+            bufferInfo.range = sizeof(GlobalUbo);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptorSets[frame];
+            write.dstBinding = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.pBufferInfo = &bufferInfo;
+
+            vkUpdateDescriptorSets(m_device.device(), 1, &write, 0, nullptr);
+        }
+    }
+
+    void GlobalUniforms::update(std::uint32_t frameIndex, const GlobalUbo& ubo)
+    {
+        std::memcpy(m_frames[frameIndex].allocation.mappedData, &ubo, sizeof(ubo));
+    }
+}
@@ -0,0 +1,471 @@
+#include "GpuDrivenRenderSystem.h"
+
+// Embedded SPIR-V
+#include "shaders/cull.comp.h"
+#include "shaders/gpu_driven.vert.h"
+#include "shaders/simple.frag.h"
+
+// glm
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+namespace VE
+{
+    // Set 1 binding 0, laid out for std430, matches cull.comp and gpu_driven.vert
+    struct ObjectData
+    {
+        glm::mat4 transform{1.0F};
+        glm::vec4 color{1.0F};
+        glm::vec4 boundingSphere{};  // model space center, radius
+        std::uint32_t drawGroup{};
+        std::uint32_t visibleOffset{};
+        std::uint32_t padding0{};
+        std::uint32_t padding1{};
+    };
+
+    struct CullPushConstants
+    {
+        std::array<glm::vec4, FrustumCuller::PLANE_COUNT> planes{};
+        std::uint32_t objectCount{};
+    };
+
+    struct DrawPushConstants
+    {
+        std::uint32_t visibleOffset{};
+    };
+
+    // Constructor
+    GpuDrivenRenderSystem::GpuDrivenRenderSystem(Device& device,
+                                                 JobSystem& jobSystem,
+                                                 PipelineRegistry& pipelineRegistry,
+                                                 VkRenderPass renderPass,
+                                                 VkDescriptorSetLayout globalSetLayout)
+        : m_device{device},
+          m_jobSystem{jobSystem},
+          m_pipelineRegistry{pipelineRegistry},
+          m_setLayout{},
+          m_descriptorPool{},
+          m_cullPipelineLayout{},
+          m_pipelineLayout{},
+          m_renderPass{renderPass}
+    {
+        createSetLayout();
+        createDescriptorSets();
+        createPipelineLayouts(globalSetLayout);
+        m_cullPipeline = createCullPipeline(Shaders::CULL_COMP);
+        m_pipeline = createPipeline(Shaders::GPU_DRIVEN_VERT, Shaders::SIMPLE_FRAG);
+    }
+
+    // Destructor
+    GpuDrivenRenderSystem::~GpuDrivenRenderSystem(void)
+    {
+        for(auto& frame : m_frames)
+        {
+            if(frame.objectBuffer)
+            {
+                m_device.destroyBuffer(frame.objectBuffer, frame.objectAllocation);
+                m_device.destroyBuffer(frame.visibleBuffer, frame.visibleAllocation);
+            }
+
+            if(frame.commandBuffer)
+            {
+                m_device.destroyBuffer(frame.commandBuffer, frame.commandAllocation);
+            }
+        }
+
+        m_pipeline.reset();
+        m_cullPipeline.reset();
+
+        vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
+        vkDestroyPipelineLayout(m_device.device(), m_cullPipelineLayout, nullptr);
+
+        // Frees the descriptor sets along with it
+        vkDestroyDescriptorPool(m_device.device(), m_descriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device.device(), m_setLayout, nullptr);
+    }
+
+    void GpuDrivenRenderSystem::createSetLayout(void)
+    {
+        // objects, commands, visible ids
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+        for(std::uint32_t binding{}; binding < bindings.size(); ++binding)
+        {
+            bindings[binding].binding = binding;
+            bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[binding].descriptorCount = 1;
+            bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+        }
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<std::uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if(vkCreateDescriptorSetLayout(m_device.device(), &layoutInfo, nullptr, &m_setLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create GPU driven descriptor set layout!"};
+        }
+    }
+
+    void GpuDrivenRenderSystem::createDescriptorSets(void)
+    {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = static_cast<std::uint32_t>(m_frames.size() * 3);
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = static_cast<std::uint32_t>(m_frames.size());
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        if(vkCreateDescriptorPool(m_device.device(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create GPU driven descriptor pool!"};
+        }
+
+        const std::vector<VkDescriptorSetLayout> setLayouts(m_frames.size(), m_setLayout);
+        std::vector<VkDescriptorSet> descriptorSets(m_frames.size());
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_descriptorPool;
+        allocInfo.descriptorSetCount = static_cast<std::uint32_t>(setLayouts.size());
+        allocInfo.pSetLayouts = setLayouts.data();
+
+        if(vkAllocateDescriptorSets(m_device.device(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to allocate GPU driven descriptor sets!"};
+        }
+
+        for(std::size_t frame{}; frame < m_frames.size(); ++frame)
+        {
+            m_frames[frame].descriptorSet = descriptorSets[frame];
+        }
+    }
+
+    void GpuDrivenRenderSystem::createPipelineLayouts(VkDescriptorSetLayout globalSetLayout)
+    {
+        // Both stages see the object data as set 1, the global set stays at 0 like in every other pipeline
+        const std::array<VkDescriptorSetLayout, 2> setLayouts{globalSetLayout, m_setLayout};
+
+        VkPushConstantRange cullRange{};
+        cullRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullRange.offset = 0;
+        cullRange.size = sizeof(CullPushConstants);
+
+        VkPipelineLayoutCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        createInfo.setLayoutCount = static_cast<std::uint32_t>(setLayouts.size());
+        createInfo.pSetLayouts = setLayouts.data();
+        createInfo.pushConstantRangeCount = 1;
+        createInfo.pPushConstantRanges = &cullRange;
+
+        if(vkCreatePipelineLayout(m_device.device(), &createInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create cull pipeline layout!"};
+        }
+
+        VkPushConstantRange drawRange{};
+        drawRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        drawRange.offset = 0;
+        drawRange.size = sizeof(DrawPushConstants);
+        createInfo.pPushConstantRanges = &drawRange;
+
+        if(vkCreatePipelineLayout(m_device.device(), &createInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create pipeline layout!"};
+        }
+    }
+
+    std::shared_ptr<ComputePipeline> GpuDrivenRenderSystem::createCullPipeline(
+          std::span<const std::uint32_t> compCode) const
+    {
+        return m_pipelineRegistry.getComputePipeline(compCode, m_cullPipelineLayout);
+    }
+
+    std::shared_ptr<Pipeline> GpuDrivenRenderSystem::createPipeline(std::span<const std::uint32_t> vertCode,
+                                                                    std::span<const std::uint32_t> fragCode) const
+    {
+        // Per-object data is fetched from the storage buffers, only the model's own vertices are bound
+        PipelineConfigInfo pipelineConfig{};
+        Pipeline::defaultPipelineConfig(pipelineConfig);
+
+        pipelineConfig.renderPass = m_renderPass;
+        pipelineConfig.pipelineLayout = m_pipelineLayout;
+
+        return m_pipelineRegistry.getPipeline(vertCode, fragCode, pipelineConfig);
+    }
+
+    void GpuDrivenRenderSystem::watchShaders(ShaderWatcher& watcher)
+    {
+        // Reloads use what the watcher just compiled, not the SPIR-V embedded at build time
+        const auto createCull{[this]
+                              {
+                                  return createCullPipeline(Pipeline::readSpirv(ShaderWatcher::spirvPath("cull.comp")));
+                              }};
+        const auto create{[this]
+                          {
+                              return createPipeline(Pipeline::readSpirv(ShaderWatcher::spirvPath("gpu_driven.vert")),
+                                                    Pipeline::readSpirv(ShaderWatcher::spirvPath("simple.frag")));
+                          }};
+
+        watcher.watch({"cull.comp"}, ShaderWatcher::replace(m_cullPipeline, createCull));
+        watcher.watch({"gpu_driven.vert", "simple.frag"}, ShaderWatcher::replace(m_pipeline, create));
+    }
+
+    void GpuDrivenRenderSystem::updateGroups(const Scene& scene)
+    {
+        const std::span<Model* const> models{scene.getModels()};
+        if(m_objectGroups.size() == models.size())
+        {
+            return;
+        }
+
+        for(std::size_t object{m_objectGroups.size()}; object < models.size(); ++object)
+        {
+            if(!models[object])
+            {
+                m_objectGroups.push_back(NO_GROUP);
+                continue;
+            }
+
+            const auto [entry, inserted]{
+                  m_groupIndices.try_emplace(models[object], static_cast<std::uint32_t>(m_groups.size()))};
+            if(inserted)
+            {
+                m_groups.push_back({models[object], 0, 0});
+            }
+
+            ++m_groups[entry->second].objectCount;
+            m_objectGroups.push_back(entry->second);
+        }
+
+        // Every group gets room for all of its objects, so no cull result can overflow into the next one
+        std::uint32_t visibleOffset{};
+        for(auto& group : m_groups)
+        {
+            group.visibleOffset = visibleOffset;
+            visibleOffset += group.objectCount;
+        }
+    }
+
+    void GpuDrivenRenderSystem::reserveObjects(FrameResources& frame, std::size_t objectCount)
+    {
+        if(frame.objectCapacity >= objectCount)
+        {
+            return;
+        }
+
+        if(frame.objectBuffer)
+        {
+            m_device.destroyBuffer(frame.objectBuffer, frame.objectAllocation);
+            m_device.destroyBuffer(frame.visibleBuffer, frame.visibleAllocation);
+        }
+
+        // Double so a slowly growing scene doesn't reallocate every frame
+        frame.objectCapacity = std::max({objectCount, frame.objectCapacity * 2, std::size_t{1024}});
+
+        // Only rewritten when the scene changed, but then in full, so mapped memory beats a staging copy
+        m_device.createBuffer(sizeof(ObjectData) * frame.objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              frame.objectBuffer, frame.objectAllocation);
+
+        // Written and read by the GPU only
+        m_device.createBuffer(sizeof(std::uint32_t) * frame.objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.visibleBuffer, frame.visibleAllocation);
+
+        // Nothing uses the set until this frame is submitted again
+        frame.uploadedVersion = std::numeric_limits<std::uint64_t>::max();
+        writeDescriptorSet(frame);
+    }
+
+    void GpuDrivenRenderSystem::reserveCommands(FrameResources& frame, std::size_t groupCount)
+    {
+        if(frame.commandCapacity >= groupCount)
+        {
+            return;
+        }
+
+        if(frame.commandBuffer)
+        {
+            m_device.destroyBuffer(frame.commandBuffer, frame.commandAllocation);
+        }
+
+        frame.commandCapacity = std::max({groupCount, frame.commandCapacity * 2, std::size_t{16}});
+
+        // A few bytes per model reset by the CPU every frame, the counts are bumped by cull.comp
+        m_device.createBuffer(sizeof(VkDrawIndexedIndirectCommand) * frame.commandCapacity,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              frame.commandBuffer, frame.commandAllocation);
+
+        writeDescriptorSet(frame);
+    }
+
+    void GpuDrivenRenderSystem::writeDescriptorSet(const FrameResources& frame)
+    {
+        // Called as soon as the first of the buffers exists, the other one is written once it does
+        if(!frame.objectBuffer || !frame.commandBuffer)
+        {
+            return;
+        }
+
+        const std::array<VkDescriptorBufferInfo, 3> bufferInfos{
+              VkDescriptorBufferInfo{frame.objectBuffer, 0, VK_WHOLE_SIZE},
+              VkDescriptorBufferInfo{frame.commandBuffer, 0, VK_WHOLE_SIZE},
+              VkDescriptorBufferInfo{frame.visibleBuffer, 0, VK_WHOLE_SIZE}};
+
+        std::array<VkWriteDescriptorSet, 3> writes{};
+        for(std::uint32_t binding{}; binding < writes.size(); ++binding)
+        {
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = frame.descriptorSet;
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[binding].pBufferInfo = &bufferInfos[binding];
+        }
+
+        vkUpdateDescriptorSets(m_device.device(), static_cast<std::uint32_t>(writes.size()), writes.data(), 0,
+                               nullptr);
+    }
+
+    void GpuDrivenRenderSystem::uploadObjects(FrameResources& frame, const Scene& scene)
+    {
+        if(frame.uploadedVersion == scene.getVersion())
+        {
+            return;
+        }
+
+        const std::span<Model* const> models{scene.getModels()};
+        const std::span<const glm::mat4> worldMatrices{scene.getWorldMatrices()};
+        const std::span<const glm::vec3> colors{scene.getColors()};
+        auto* objects{static_cast<ObjectData*>(frame.objectAllocation.mappedData)};
+
+        m_jobSystem.parallelFor(scene.size(), MIN_OBJECTS_PER_UPLOAD_RANGE,
+                                [&](std::size_t begin, std::size_t end)
+                                {
+                                    for(std::size_t object{begin}; object < end; ++object)
+                                    {
+                                        ObjectData data{};
+                                        data.transform = worldMatrices[object];
+                                        data.color = glm::vec4{colors[object], 1.0F};
+                                        data.drawGroup = m_objectGroups[object];
+
+                                        if(data.drawGroup != NO_GROUP)
+                                        {
+                                            const BoundingSphere& bounds{models[object]->getBoundingSphere()};
+                                            data.boundingSphere = glm::vec4{bounds.center, bounds.radius};
+                                            data.visibleOffset = m_groups[data.drawGroup].visibleOffset;
+                                        }
+
+                                        std::memcpy(objects + object, &data, sizeof(data));
+                                    }
+                                });
+
+        frame.uploadedVersion = scene.getVersion();
+    }
+
+    void GpuDrivenRenderSystem::update(FrameInfo& frameInfo, const Scene& scene)
+    {
+        FrameResources& frame{m_frames[frameInfo.frameIndex]};
+
+        updateGroups(scene);
+        reserveObjects(frame, scene.size());
+        reserveCommands(frame, m_groups.size());
+        uploadObjects(frame, scene);
+
+        // Zero instances everywhere, cull.comp counts them back up
+        auto* commands{static_cast<VkDrawIndexedIndirectCommand*>(frame.commandAllocation.mappedData)};
+        for(std::size_t group{}; group < m_groups.size(); ++group)
+        {
+            const VkDrawIndexedIndirectCommand command{m_groups[group].model->getIndirectCommand(0, 0)};
+            std::memcpy(commands + group, &command, sizeof(command));
+        }
+    }
+
+    void GpuDrivenRenderSystem::cull(FrameInfo& frameInfo)
+    {
+        const FrameResources& frame{m_frames[frameInfo.frameIndex]};
+
+        // One entry per scene object since the last update()
+        const std::size_t objectCount{m_objectGroups.size()};
+        if(objectCount == 0)
+        {
+            return;
+        }
+
+        m_culler.setViewProjection(frameInfo.camera.getProjection() * frameInfo.camera.getView());
+
+        CullPushConstants push{};
+        for(std::size_t plane{}; plane < FrustumCuller::PLANE_COUNT; ++plane)
+        {
+            push.planes[plane] = m_culler.getPlane(plane);
+        }
+        push.objectCount = static_cast<std::uint32_t>(objectCount);
+
+        const std::uint32_t scope{frameInfo.gpuProfiler.beginScope(frameInfo.commandBuffer, "gpuCulling")};
+
+        m_cullPipeline->bind(frameInfo.commandBuffer);
+        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 1, 1,
+                                &frame.descriptorSet, 0, nullptr);
+        vkCmdPushConstants(frameInfo.commandBuffer, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(push), &push);
+
+        // local_size_x of cull.comp
+        constexpr std::uint32_t GROUP_SIZE{64};
+        vkCmdDispatch(frameInfo.commandBuffer, (push.objectCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+        frameInfo.gpuProfiler.endScope(frameInfo.commandBuffer, scope);
+    }
+
+    void GpuDrivenRenderSystem::render(FrameInfo& frameInfo)
+    {
+        const FrameResources& frame{m_frames[frameInfo.frameIndex]};
+        if(m_groups.empty())
+        {
+            return;
+        }
+
+        // One draw per model, too few to be worth spreading over the recording threads
+        const VkCommandBuffer secondary{frameInfo.commandRecorder.recordInline(
+              [&](VkCommandBuffer commandBuffer)
+              {
+                  const std::uint32_t scope{frameInfo.gpuProfiler.beginScope(commandBuffer, "gpuDrivenRenderSystem")};
+
+                  m_pipeline->bind(commandBuffer);
+
+                  const std::array<VkDescriptorSet, 2> descriptorSets{frameInfo.globalDescriptorSet,
+                                                                       frame.descriptorSet};
+                  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0,
+                                          static_cast<std::uint32_t>(descriptorSets.size()), descriptorSets.data(), 0,
+                                          nullptr);
+
+                  // Groups nothing survived in still draw, with zero instances
+                  for(std::size_t group{}; group < m_groups.size(); ++group)
+                  {
+                      const DrawPushConstants push{m_groups[group].visibleOffset};
+                      vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push),
+                                         &push);
+
+                      m_groups[group].model->bind(commandBuffer);
+                      m_groups[group].model->drawIndirect(commandBuffer, frame.commandBuffer,
+                                                          sizeof(VkDrawIndexedIndirectCommand) * group);
+                  }
+
+                  frameInfo.gpuProfiler.endScope(commandBuffer, scope);
+              })};
+
+        vkCmdExecuteCommands(frameInfo.commandBuffer, 1, &secondary);
+    }
+}
@@ -0,0 +1,137 @@
+#include "GpuProfiler.h"
+
+// std
+#include <array>
+#include <stdexcept>
+
+namespace VE
+{
+    // Constructor
+    GpuProfiler::GpuProfiler(Device& device, std::uint32_t framesInFlight, std::uint32_t maxScopes)
+        : m_device{device},
+          m_frames(framesInFlight),
+          m_maxScopes{maxScopes},
+          m_currentFrame{},
+          m_timestampMask{},
+          m_timestampPeriod{static_cast<double>(device.getPhysicalDeviceProperties().limits.timestampPeriod)},
+          m_supported{}
+    {
+        // Zero valid bits means the graphics queue can't write timestamps at all
+        const std::uint32_t validBits{m_device.getQueueFamilyProperties(
+                                             m_device.findPhysicalQueueFamilies().graphicsFamily.value())
+                                            .timestampValidBits};
+
+        m_supported = validBits > 0 && m_timestampPeriod > 0.0;
+        if(!m_supported)
+        {
+            return;
+        }
+
+        m_timestampMask = validBits >= 64 ? ~std::uint64_t{} : (std::uint64_t{1} << validBits) - 1;
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = m_maxScopes * 2;
+
+        for(auto& frame : m_frames)
+        {
+            if(vkCreateQueryPool(m_device.device(), &poolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to create timestamp query pool!"};
+            }
+            frame.scopeNames.reserve(m_maxScopes);
+        }
+    }
+
+    // Destructor
+    GpuProfiler::~GpuProfiler(void)
+    {
+        for(auto& frame : m_frames)
+        {
+            vkDestroyQueryPool(m_device.device(), frame.queryPool, nullptr);
+        }
+    }
+
+    void GpuProfiler::readBack(FrameQueries& frame)
+    {
+        if(!frame.recorded || frame.scopeNames.empty())
+        {
+            return;
+        }
+
+        const auto queryCount{static_cast<std::uint32_t>(frame.scopeNames.size() * 2)};
+        std::vector<std::uint64_t> timestamps(queryCount);
+
+        // No WAIT bit, the frame timeline already told us the work is done and we never want to stall here
+        const VkResult result{vkGetQueryPoolResults(m_device.device(),
+                                                    frame.queryPool,
+                                                    0,
+                                                    queryCount,
+                                                    timestamps.size() * sizeof(std::uint64_t),
+                                                    timestamps.data(),
+                                                    sizeof(std::uint64_t),
+                                                    VK_QUERY_RESULT_64_BIT)};
+        if(result != VK_SUCCESS)
+        {
+            return;
+        }
+
+        for(std::size_t scope{}; scope < frame.scopeNames.size(); ++scope)
+        {
+            const std::uint64_t ticks{(timestamps[scope * 2 + 1] - timestamps[scope * 2]) & m_timestampMask};
+            m_results.push_back({frame.scopeNames[scope], static_cast<double>(ticks) * m_timestampPeriod / 1.0e6});
+        }
+    }
+
+    void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, std::uint32_t frameIndex)
+    {
+        if(!m_supported)
+        {
+            return;
+        }
+
+        m_currentFrame = frameIndex;
+        FrameQueries& frame{m_frames[m_currentFrame]};
+
+        // Stale timings must not be reported twice if this slot has nothing new
+        m_results.clear();
+        readBack(frame);
+
+        vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, m_maxScopes * 2);
+        frame.scopeNames.clear();
+        frame.recorded = true;
+    }
+
+    std::uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer,
+                                          const std::string& name,
+                                          VkPipelineStageFlagBits stage)
+    {
+        if(!m_supported)
+        {
+            return INVALID_SCOPE;
+        }
+
+        FrameQueries& frame{m_frames[m_currentFrame]};
+        if(frame.scopeNames.size() >= m_maxScopes)
+        {
+            return INVALID_SCOPE;
+        }
+
+        const auto scope{static_cast<std::uint32_t>(frame.scopeNames.size())};
+        frame.scopeNames.push_back(name);
+
+        vkCmdWriteTimestamp(commandBuffer, stage, frame.queryPool, scope * 2);
+        return scope;
+    }
+
+    void GpuProfiler::endScope(VkCommandBuffer commandBuffer, std::uint32_t scope, VkPipelineStageFlagBits stage)
+    {
+        if(scope == INVALID_SCOPE)
+        {
+            return;
+        }
+
+        vkCmdWriteTimestamp(commandBuffer, stage, m_frames[m_currentFrame].queryPool, scope * 2 + 1);
+    }
+}
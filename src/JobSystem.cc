@@ -0,0 +1,311 @@
+#include "JobSystem.h"
+
+// std
+#include <stdexcept>
+
+// Thread affinity
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace VE
+{
+    // Which system the current thread works for and its index there
+    static thread_local const JobSystem* t_jobSystem{};
+    static thread_local std::uint32_t t_threadIndex{};
+
+    // Tries a worker makes before it goes to sleep, a frame's jobs usually arrive in quick bursts
+    static constexpr std::uint32_t IDLE_SPINS{64};
+
+    bool JobSystem::WorkQueue::push(Task* task)
+    {
+        const std::int64_t bottom{m_bottom.load(std::memory_order_relaxed)};
+        const std::int64_t top{m_top.load(std::memory_order_acquire)};
+
+        if(bottom - top >= CAPACITY)
+        {
+            return false;
+        }
+
+        m_tasks[static_cast<std::size_t>(bottom % CAPACITY)].store(task, std::memory_order_relaxed);
+
+        // Publishes the slot to thieves
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    JobSystem::Task* JobSystem::WorkQueue::pop(void)
+    {
+        const std::int64_t bottom{m_bottom.load(std::memory_order_relaxed) - 1};
+
+        // Claim the slot first, then look whether a thief got there too. Both need to be sequentially consistent
+        m_bottom.store(bottom, std::memory_order_seq_cst);
+        std::int64_t top{m_top.load(std::memory_order_seq_cst)};
+
+        if(top > bottom)
+        {
+            // Empty
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Task* task{m_tasks[static_cast<std::size_t>(bottom % CAPACITY)].load(std::memory_order_relaxed)};
+        if(top == bottom)
+        {
+            // Last one left, race the thieves for it
+            if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                task = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    JobSystem::Task* JobSystem::WorkQueue::steal(void)
+    {
+        std::int64_t top{m_top.load(std::memory_order_seq_cst)};
+        const std::int64_t bottom{m_bottom.load(std::memory_order_seq_cst)};
+
+        if(top >= bottom)
+        {
+            return nullptr;
+        }
+
+        Task* task{m_tasks[static_cast<std::size_t>(top % CAPACITY)].load(std::memory_order_relaxed)};
+        if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            // Someone else was faster
+            return nullptr;
+        }
+        return task;
+    }
+
+    // Constructor
+    JobSystem::JobSystem(std::uint32_t threadCount, bool pinThreads)
+        : m_threadCount{threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1U)}
+    {
+        if(t_jobSystem)
+        {
+            throw std::runtime_error{"A thread can only belong to one job system!"};
+        }
+
+        for(std::uint32_t thread{}; thread < m_threadCount; ++thread)
+        {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+
+        t_jobSystem = this;
+        t_threadIndex = 0;
+        if(pinThreads)
+        {
+            pinToCore(0);
+        }
+
+        for(std::uint32_t thread{1}; thread < m_threadCount; ++thread)
+        {
+            m_workers.emplace_back(
+                  [this, thread, pinThreads]
+                  {
+                      t_jobSystem = this;
+                      t_threadIndex = thread;
+                      if(pinThreads)
+                      {
+                          pinToCore(thread);
+                      }
+                      workerLoop(thread);
+                  });
+        }
+    }
+
+    // Destructor
+    JobSystem::~JobSystem(void)
+    {
+        m_stopping.store(true, std::memory_order_release);
+        m_workEpoch.fetch_add(1, std::memory_order_seq_cst);
+        m_workEpoch.notify_all();
+        m_workers.clear();
+
+        // Nobody waits for jobs that are still queued, drop them. Only run() jobs can be left, parallelFor() waits
+        for(auto& queue : m_queues)
+        {
+            while(Task* task{queue->pop()})
+            {
+                if(task->owned)
+                {
+                    delete static_cast<Job*>(task->function);
+                    delete task;
+                }
+            }
+        }
+
+        t_jobSystem = nullptr;
+    }
+
+    void JobSystem::pinToCore(std::uint32_t core)
+    {
+#if defined(__linux__)
+        const auto coreCount{static_cast<std::uint32_t>(std::max(std::thread::hardware_concurrency(), 1U))};
+
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(core % coreCount, &cpuSet);
+
+        // Best effort, a restricted cpuset just leaves the thread floating
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+        static_cast<void>(core);
+#endif
+    }
+
+    std::uint32_t JobSystem::getThreadIndex(void) const
+    {
+        if(t_jobSystem != this)
+        {
+            throw std::runtime_error{"Calling thread isn't a worker of this job system!"};
+        }
+        return t_threadIndex;
+    }
+
+    void JobSystem::run(Job job, Counter& counter)
+    {
+        auto* task{new Task{}};
+        task->invoke = [](void* function, std::size_t, std::size_t) { (*static_cast<Job*>(function))(); };
+        task->function = new Job{std::move(job)};
+        task->counter = &counter;
+        task->owned = true;
+
+        submit(task);
+    }
+
+    void JobSystem::submit(Task* task)
+    {
+        const std::uint32_t threadIndex{getThreadIndex()};
+
+        task->counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+        if(!m_queues[threadIndex]->push(task))
+        {
+            // Deque is full, doing it right away still makes progress
+            execute(task);
+            return;
+        }
+
+        m_workEpoch.fetch_add(1, std::memory_order_seq_cst);
+        if(m_sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+        {
+            m_workEpoch.notify_one();
+        }
+    }
+
+    void JobSystem::wait(Counter& counter)
+    {
+        const std::uint32_t threadIndex{getThreadIndex()};
+
+        while(counter.pending.load(std::memory_order_acquire) != 0)
+        {
+            if(Task* task{findTask(threadIndex)})
+            {
+                execute(task);
+            }
+            else
+            {
+                // The rest is running on other workers
+                std::this_thread::yield();
+            }
+        }
+
+        std::exception_ptr error{};
+        {
+            std::lock_guard<std::mutex> lock{counter.errorMutex};
+            std::swap(error, counter.error);
+        }
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    JobSystem::Task* JobSystem::findTask(std::uint32_t threadIndex)
+    {
+        if(Task* task{m_queues[threadIndex]->pop()})
+        {
+            return task;
+        }
+
+        for(std::uint32_t offset{1}; offset < m_threadCount; ++offset)
+        {
+            if(Task* task{m_queues[(threadIndex + offset) % m_threadCount]->steal()})
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::execute(Task* task)
+    {
+        Counter* counter{task->counter};
+
+        try
+        {
+            task->invoke(task->function, task->begin, task->end);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock{counter->errorMutex};
+            if(!counter->error)
+            {
+                counter->error = std::current_exception();
+            }
+        }
+
+        // The job's captures may point into the waiter's stack, they go before the waiter is released.
+        // parallelFor() tasks are on that stack themselves, they can't be touched after it
+        if(task->owned)
+        {
+            delete static_cast<Job*>(task->function);
+            delete task;
+        }
+        counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void JobSystem::workerLoop(std::uint32_t threadIndex)
+    {
+        std::uint32_t idleSpins{};
+
+        while(!m_stopping.load(std::memory_order_acquire))
+        {
+            if(Task* task{findTask(threadIndex)})
+            {
+                execute(task);
+                idleSpins = 0;
+                continue;
+            }
+
+            if(++idleSpins < IDLE_SPINS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Read the epoch before the last look, a job submitted after that look changes it and wait() returns
+            const std::uint64_t epoch{m_workEpoch.load(std::memory_order_seq_cst)};
+            if(Task* task{findTask(threadIndex)})
+            {
+                execute(task);
+                idleSpins = 0;
+                continue;
+            }
+
+            m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            if(!m_stopping.load(std::memory_order_acquire))
+            {
+                m_workEpoch.wait(epoch, std::memory_order_seq_cst);
+            }
+            m_sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+            idleSpins = 0;
+        }
+    }
+}
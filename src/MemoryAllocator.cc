@@ -0,0 +1,346 @@
+#include "MemoryAllocator.h"
+
+// std
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace VE
+{
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return alignment > 1 ? (value + alignment - 1) & ~(alignment - 1) : value;
+    }
+
+    // Constructor
+    MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice)
+        : m_device{device},
+          m_memoryProperties{},
+          m_maxAllocationCount{},
+          m_blockSizes{},
+          m_deviceMemoryCount{},
+          m_dedicatedAllocationCount{},
+          m_dedicatedBytes{}
+    {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        m_maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+        // Small heaps (e.g. the 256MiB BAR window) would be eaten by a couple of blocks
+        for(std::uint32_t typeIndex{}; typeIndex < m_memoryProperties.memoryTypeCount; ++typeIndex)
+        {
+            const VkDeviceSize heapSize{
+                  m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[typeIndex].heapIndex].size};
+
+            m_blockSizes[typeIndex] = heapSize <= 1024ULL * 1024 * 1024 ? heapSize / 8 : PREFERRED_BLOCK_SIZE;
+        }
+    }
+
+    // Destructor
+    MemoryAllocator::~MemoryAllocator(void)
+    {
+        for(auto& pool : m_pools)
+        {
+            for(auto& block : pool)
+            {
+                freeDeviceMemory(block->memory, block->mappedData != nullptr);
+            }
+        }
+    }
+
+    MemoryAllocator::Pool& MemoryAllocator::getPool(std::uint32_t memoryTypeIndex, ResourceKind kind)
+    {
+        return m_pools[memoryTypeIndex * 2 + static_cast<std::uint32_t>(kind)];
+    }
+
+    std::uint32_t MemoryAllocator::findMemoryType(std::uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        for(std::uint32_t typeIndex{}; typeIndex < m_memoryProperties.memoryTypeCount; ++typeIndex)
+        {
+            if((typeFilter & (1U << typeIndex)) &&
+               (m_memoryProperties.memoryTypes[typeIndex].propertyFlags & properties) == properties)
+            {
+                return typeIndex;
+            }
+        }
+
+        throw std::runtime_error{"Failed to find suitable memory type!"};
+    }
+
+    VkDeviceMemory MemoryAllocator::allocateDeviceMemory(VkDeviceSize size,
+                                                         std::uint32_t memoryTypeIndex,
+                                                         void** mappedData)
+    {
+        if(m_deviceMemoryCount >= m_maxAllocationCount)
+        {
+            throw std::runtime_error{"Reached maxMemoryAllocationCount (" + std::to_string(m_maxAllocationCount) +
+                                     ")!"};
+        }
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+        VkDeviceMemory memory{};
+        if(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to allocate device memory!"};
+        }
+        ++m_deviceMemoryCount;
+
+        // Host visible memory stays mapped for its whole life, a memory object can only be mapped once
+        *mappedData = nullptr;
+        if(m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            if(vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, mappedData) != VK_SUCCESS)
+            {
+                *mappedData = nullptr;
+                freeDeviceMemory(memory, false);
+                throw std::runtime_error{"Failed to map device memory!"};
+            }
+        }
+
+        return memory;
+    }
+
+    void MemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, bool mapped)
+    {
+        if(mapped)
+        {
+            vkUnmapMemory(m_device, memory);
+        }
+
+        vkFreeMemory(m_device, memory, nullptr);
+        --m_deviceMemoryCount;
+    }
+
+    bool MemoryAllocator::allocateFromBlock(Block& block,
+                                            const VkMemoryRequirements& requirements,
+                                            Allocation& allocation)
+    {
+        // Best fit keeps the big holes big
+        auto best{block.freeRanges.end()};
+        VkDeviceSize bestOffset{};
+        VkDeviceSize bestLeftover{std::numeric_limits<VkDeviceSize>::max()};
+
+        for(auto range{block.freeRanges.begin()}; range != block.freeRanges.end(); ++range)
+        {
+            const VkDeviceSize rangeEnd{range->first + range->second};
+            const VkDeviceSize alignedOffset{alignUp(range->first, requirements.alignment)};
+            if(alignedOffset > rangeEnd || requirements.size > rangeEnd - alignedOffset)
+            {
+                continue;
+            }
+
+            // What stays free behind the allocation, the alignment padding in front of it is no use either
+            const VkDeviceSize leftover{rangeEnd - alignedOffset - requirements.size};
+            if(leftover < bestLeftover)
+            {
+                best = range;
+                bestOffset = alignedOffset;
+                bestLeftover = leftover;
+            }
+
+            if(leftover == 0)
+            {
+                break;
+            }
+        }
+
+        if(best == block.freeRanges.end())
+        {
+            return false;
+        }
+
+        const VkDeviceSize rangeOffset{best->first};
+        const VkDeviceSize rangeEnd{best->first + best->second};
+        const VkDeviceSize allocationEnd{bestOffset + requirements.size};
+        block.freeRanges.erase(best);
+
+        // Alignment padding and the tail go back to the free list
+        if(bestOffset > rangeOffset)
+        {
+            block.freeRanges.emplace(rangeOffset, bestOffset - rangeOffset);
+        }
+        if(allocationEnd < rangeEnd)
+        {
+            block.freeRanges.emplace(allocationEnd, rangeEnd - allocationEnd);
+        }
+
+        block.usedBytes += requirements.size;
+        ++block.allocationCount;
+
+        allocation.memory = block.memory;
+        allocation.offset = bestOffset;
+        allocation.size = requirements.size;
+        allocation.mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + bestOffset : nullptr;
+        allocation.dedicated = false;
+
+        return true;
+    }
+
+    void MemoryAllocator::freeToBlock(Block& block, const Allocation& allocation)
+    {
+        VkDeviceSize offset{allocation.offset};
+        VkDeviceSize size{allocation.size};
+
+        auto next{block.freeRanges.lower_bound(offset)};
+
+        // Merge with the following hole
+        if(next != block.freeRanges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = block.freeRanges.erase(next);
+        }
+
+        // Merge with the preceding hole
+        if(next != block.freeRanges.begin())
+        {
+            auto previous{std::prev(next)};
+            if(previous->first + previous->second == offset)
+            {
+                offset = previous->first;
+                size += previous->second;
+                block.freeRanges.erase(previous);
+            }
+        }
+
+        block.freeRanges.emplace(offset, size);
+        block.usedBytes -= allocation.size;
+        --block.allocationCount;
+    }
+
+    Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements,
+                                         VkMemoryPropertyFlags properties,
+                                         ResourceKind kind)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        Allocation allocation{};
+        allocation.memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+        allocation.kind = kind;
+
+        const VkDeviceSize blockSize{m_blockSizes[allocation.memoryTypeIndex]};
+
+        if(requirements.size > blockSize / 2)
+        {
+            allocation.memory =
+                  allocateDeviceMemory(requirements.size, allocation.memoryTypeIndex, &allocation.mappedData);
+            allocation.offset = 0;
+            allocation.size = requirements.size;
+            allocation.dedicated = true;
+
+            ++m_dedicatedAllocationCount;
+            m_dedicatedBytes += requirements.size;
+            return allocation;
+        }
+
+        Pool& pool{getPool(allocation.memoryTypeIndex, kind)};
+        for(auto& block : pool)
+        {
+            if(allocateFromBlock(*block, requirements, allocation))
+            {
+                return allocation;
+            }
+        }
+
+        auto block{std::make_unique<Block>()};
+        block->size = blockSize;
+        block->memory = allocateDeviceMemory(blockSize, allocation.memoryTypeIndex, &block->mappedData);
+        block->freeRanges.emplace(0, blockSize);
+
+        if(!allocateFromBlock(*block, requirements, allocation))
+        {
+            freeDeviceMemory(block->memory, block->mappedData != nullptr);
+            throw std::runtime_error{"Allocation doesn't fit into a fresh memory block!"};
+        }
+
+        pool.push_back(std::move(block));
+        return allocation;
+    }
+
+    void MemoryAllocator::free(Allocation& allocation)
+    {
+        if(allocation.memory == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        if(allocation.dedicated)
+        {
+            freeDeviceMemory(allocation.memory, allocation.mappedData != nullptr);
+
+            --m_dedicatedAllocationCount;
+            m_dedicatedBytes -= allocation.size;
+            allocation = {};
+            return;
+        }
+
+        Pool& pool{getPool(allocation.memoryTypeIndex, allocation.kind)};
+        auto owner{std::find_if(
+              pool.begin(), pool.end(), [&](const auto& block) { return block->memory == allocation.memory; })};
+
+        if(owner == pool.end())
+        {
+            throw std::runtime_error{"Freeing an allocation that doesn't belong to this allocator!"};
+        }
+
+        freeToBlock(**owner, allocation);
+
+        // Keep one empty block around so a free/allocate pattern doesn't hit vkAllocateMemory every time
+        if((*owner)->allocationCount == 0)
+        {
+            const auto emptyBlocks{
+                  std::count_if(pool.begin(), pool.end(), [](const auto& block) { return block->allocationCount == 0; })};
+
+            if(emptyBlocks > 1)
+            {
+                freeDeviceMemory((*owner)->memory, (*owner)->mappedData != nullptr);
+                pool.erase(owner);
+            }
+        }
+
+        allocation = {};
+    }
+
+    [[nodiscard]] MemoryStatistics MemoryAllocator::getStatistics(void)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        MemoryStatistics statistics{};
+        statistics.dedicatedAllocationCount = m_dedicatedAllocationCount;
+        statistics.dedicatedBytes = m_dedicatedBytes;
+        statistics.deviceMemoryCount = m_deviceMemoryCount;
+        statistics.allocationCount = m_dedicatedAllocationCount;
+
+        VkDeviceSize freeBytes{};
+        for(const auto& pool : m_pools)
+        {
+            for(const auto& block : pool)
+            {
+                ++statistics.blockCount;
+                statistics.allocationCount += block->allocationCount;
+                statistics.reservedBytes += block->size;
+                statistics.usedBytes += block->usedBytes;
+                statistics.freeRangeCount += block->freeRanges.size();
+
+                for(const auto& [offset, size] : block->freeRanges)
+                {
+                    freeBytes += size;
+                    statistics.largestFreeRange = std::max(statistics.largestFreeRange, size);
+                }
+            }
+        }
+
+        statistics.fragmentation = freeBytes ? 1.0 - static_cast<double>(statistics.largestFreeRange) /
+                                                     static_cast<double>(freeBytes)
+                                             : 0.0;
+        return statistics;
+    }
+}
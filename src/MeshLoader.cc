@@ -0,0 +1,377 @@
+#include "MeshLoader.h"
+
+// tinyobjloader
+#include <tiny_obj_loader.h>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// mmap
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VE
+{
+    static_assert(std::is_trivially_copyable_v<Model::Vertex>, "Model::Vertex is written to the cache as raw bytes");
+
+    static constexpr std::array<char, 8> CACHE_MAGIC{'V', 'E', 'M', 'E', 'S', 'H', '\0', '\0'};
+
+    // Welding is the expensive part of an import, chunks smaller than this aren't worth a thread
+    static constexpr std::size_t MIN_TRIANGLES_PER_CHUNK{64 * 1024};
+
+    struct CacheHeader
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t vertexSize;
+
+        // The cache is stale as soon as the .obj it was built from changes
+        std::uint64_t sourceSize;
+        std::int64_t sourceWriteTime;
+
+        std::uint64_t vertexCount;
+        std::uint64_t indexCount;
+    };
+
+    // Read only view of a whole file, mapped where the platform lets us
+    class MappedFile final
+    {
+    private:  // Private variables
+        const std::byte* m_data{};
+        std::size_t m_size{};
+        std::vector<std::byte> m_fallback;
+
+    public:  // Public methods
+        /*------------------------------------------------------------------*/
+        /*                  Don't copy or move my class!!!                  */
+
+        MappedFile(const MappedFile& copy) = delete;
+        MappedFile& operator=(const MappedFile& copy) = delete;
+        MappedFile(MappedFile&& move) = delete;
+        MappedFile& operator=(MappedFile&& move) = delete;
+        /*------------------------------------------------------------------*/
+
+        // Constructor, an empty view if the file can't be opened
+        MappedFile(const std::filesystem::path& path)
+        {
+#if !defined(_WIN32)
+            const int file{open(path.c_str(), O_RDONLY)};
+            if(file < 0)
+            {
+                return;
+            }
+
+            struct stat status{};
+            if(fstat(file, &status) == 0 && status.st_size > 0)
+            {
+                void* mapping{mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0)};
+                if(mapping != MAP_FAILED)
+                {
+                    m_data = static_cast<const std::byte*>(mapping);
+                    m_size = static_cast<std::size_t>(status.st_size);
+                }
+            }
+
+            // The mapping keeps the file alive on its own
+            close(file);
+#else
+            std::ifstream file{path, std::ios::binary | std::ios::ate};
+            if(!file)
+            {
+                return;
+            }
+
+            m_fallback.resize(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(m_fallback.data()), static_cast<std::streamsize>(m_fallback.size()));
+            m_data = m_fallback.data();
+            m_size = m_fallback.size();
+#endif
+        }
+
+        // Destructor
+        ~MappedFile(void)
+        {
+#if !defined(_WIN32)
+            if(m_data)
+            {
+                munmap(const_cast<std::byte*>(m_data), m_size);
+            }
+#endif
+        }
+
+        [[nodiscard]] const std::byte* data(void) const { return m_data; }
+        [[nodiscard]] std::size_t size(void) const { return m_size; }
+    };
+
+    // Either a mapped cache or a freshly parsed mesh, the spans point into whichever one we got
+    struct MeshData
+    {
+        std::unique_ptr<MappedFile> cache;
+        Model::Builder builder;
+        std::span<const Model::Vertex> vertices;
+        std::span<const std::uint32_t> indices;
+    };
+
+    static CacheHeader describeSource(const std::filesystem::path& objPath)
+    {
+        CacheHeader header{};
+        header.magic = CACHE_MAGIC;
+        header.version = MeshLoader::CACHE_VERSION;
+        header.vertexSize = sizeof(Model::Vertex);
+        header.sourceSize = std::filesystem::file_size(objPath);
+        header.sourceWriteTime =
+              static_cast<std::int64_t>(std::filesystem::last_write_time(objPath).time_since_epoch().count());
+        return header;
+    }
+
+    // Returns false if there is no usable cache, mesh is left untouched then
+    static bool mapCache(const std::filesystem::path& cachePath, const CacheHeader& expected, MeshData& mesh)
+    {
+        auto cache{std::make_unique<MappedFile>(cachePath)};
+        if(cache->size() < sizeof(CacheHeader))
+        {
+            return false;
+        }
+
+        CacheHeader header{};
+        std::memcpy(&header, cache->data(), sizeof(header));
+
+        if(header.magic != CACHE_MAGIC || header.version != expected.version ||
+           header.vertexSize != expected.vertexSize || header.sourceSize != expected.sourceSize ||
+           header.sourceWriteTime != expected.sourceWriteTime)
+        {
+            return false;
+        }
+
+        const std::size_t vertexBytes{header.vertexCount * sizeof(Model::Vertex)};
+        const std::size_t indexBytes{header.indexCount * sizeof(std::uint32_t)};
+        if(cache->size() != sizeof(CacheHeader) + vertexBytes + indexBytes)
+        {
+            return false;
+        }
+
+        // The header keeps both arrays 4 byte aligned within the page aligned mapping
+        const std::byte* vertices{cache->data() + sizeof(CacheHeader)};
+        mesh.vertices = {reinterpret_cast<const Model::Vertex*>(vertices), header.vertexCount};
+        mesh.indices = {reinterpret_cast<const std::uint32_t*>(vertices + vertexBytes), header.indexCount};
+        mesh.cache = std::move(cache);
+        return true;
+    }
+
+    // A failed write only costs us the next load, so it is reported and otherwise ignored
+    static void writeCache(const std::filesystem::path& cachePath, CacheHeader header, const Model::Builder& builder)
+    {
+        header.vertexCount = builder.vertices.size();
+        header.indexCount = builder.indices.size();
+
+        // Write next to it and rename, a concurrent or crashed run never sees half a cache
+        std::filesystem::path tempPath{cachePath};
+        tempPath += ".tmp";
+
+        {
+            std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(builder.vertices.data()),
+                       static_cast<std::streamsize>(builder.vertices.size() * sizeof(Model::Vertex)));
+            file.write(reinterpret_cast<const char*>(builder.indices.data()),
+                       static_cast<std::streamsize>(builder.indices.size() * sizeof(std::uint32_t)));
+
+            if(!file)
+            {
+                std::cerr << "Failed to write mesh cache " << cachePath << '\n';
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if(error)
+        {
+            std::cerr << "Failed to write mesh cache " << cachePath << ": " << error.message() << '\n';
+            std::filesystem::remove(tempPath, error);
+        }
+    }
+
+    static MeshData loadMeshData(JobSystem& jobSystem, const std::filesystem::path& objPath)
+    {
+        if(!std::filesystem::exists(objPath))
+        {
+            throw std::runtime_error{"Mesh " + objPath.string() + " doesn't exist!"};
+        }
+
+        const std::filesystem::path cachePath{MeshLoader::getCachePath(objPath)};
+        const CacheHeader source{describeSource(objPath)};
+
+        MeshData mesh{};
+        if(mapCache(cachePath, source, mesh))
+        {
+            return mesh;
+        }
+
+        mesh.builder = MeshLoader::parseObj(jobSystem, objPath);
+        mesh.vertices = mesh.builder.vertices;
+        mesh.indices = mesh.builder.indices;
+
+        writeCache(cachePath, source, mesh.builder);
+        return mesh;
+    }
+
+    std::filesystem::path MeshLoader::getCachePath(const std::filesystem::path& objPath)
+    {
+        std::filesystem::path cachePath{objPath};
+        cachePath += ".vemesh";
+        return cachePath;
+    }
+
+    Model::Builder MeshLoader::parseObj(JobSystem& jobSystem, const std::filesystem::path& objPath)
+    {
+        tinyobj::ObjReaderConfig config{};
+        config.triangulate = true;
+        config.vertex_color = true;
+        config.mtl_search_path = objPath.parent_path().string();
+
+        tinyobj::ObjReader reader{};
+        if(!reader.ParseFromFile(objPath.string(), config))
+        {
+            throw std::runtime_error{"Failed to load " + objPath.string() + ": " + reader.Error()};
+        }
+
+        const tinyobj::attrib_t& attrib{reader.GetAttrib()};
+
+        // Every shape is cut into runs of whole triangles, each run is welded as its own job
+        struct Chunk
+        {
+            const tinyobj::mesh_t* mesh;
+            std::size_t first;
+            std::size_t count;
+        };
+
+        std::size_t triangleCount{};
+        for(const auto& shape : reader.GetShapes())
+        {
+            triangleCount += shape.mesh.indices.size() / 3;
+        }
+
+        const std::size_t threadCount{jobSystem.getThreadCount()};
+        const std::size_t indicesPerChunk{
+              std::max(MIN_TRIANGLES_PER_CHUNK, (triangleCount + threadCount - 1) / threadCount) * 3};
+
+        std::vector<Chunk> chunks;
+        for(const auto& shape : reader.GetShapes())
+        {
+            const std::size_t indexCount{shape.mesh.indices.size() / 3 * 3};
+            for(std::size_t first{}; first < indexCount; first += indicesPerChunk)
+            {
+                chunks.push_back({&shape.mesh, first, std::min(indicesPerChunk, indexCount - first)});
+            }
+        }
+
+        const auto weldChunk{[&attrib](const Chunk& chunk)
+                             {
+                                 std::vector<Model::Vertex> triangleSoup(chunk.count);
+
+                                 for(std::size_t i{}; i < chunk.count; ++i)
+                                 {
+                                     const tinyobj::index_t index{chunk.mesh->indices[chunk.first + i]};
+                                     if(index.vertex_index < 0)
+                                     {
+                                         throw std::runtime_error{"Face without a position in .obj file!"};
+                                     }
+
+                                     const auto vertex{static_cast<std::size_t>(index.vertex_index) * 3};
+                                     triangleSoup[i].position = {
+                                           attrib.vertices[vertex], attrib.vertices[vertex + 1],
+                                           attrib.vertices[vertex + 2]};
+
+                                     // tinyobjloader fills in white when the file has no vertex colors
+                                     triangleSoup[i].color = attrib.colors.size() >= vertex + 3
+                                                                   ? glm::vec3{attrib.colors[vertex],
+                                                                               attrib.colors[vertex + 1],
+                                                                               attrib.colors[vertex + 2]}
+                                                                   : glm::vec3{1.0F};
+                                 }
+
+                                 return Model::Builder::weld(triangleSoup);
+                             }};
+
+        std::vector<Model::Builder> welded(chunks.size());
+        jobSystem.parallelFor(chunks.size(), 1,
+                              [&](std::size_t begin, std::size_t end)
+                              {
+                                  for(std::size_t chunk{begin}; chunk < end; ++chunk)
+                                  {
+                                      welded[chunk] = weldChunk(chunks[chunk]);
+                                  }
+                              });
+
+        Model::Builder builder{};
+
+        // Vertices shared across a chunk border are kept twice, a handful per chunk
+        for(const Model::Builder& part : welded)
+        {
+            const auto base{static_cast<std::uint32_t>(builder.vertices.size())};
+
+            builder.vertices.insert(builder.vertices.end(), part.vertices.begin(), part.vertices.end());
+            for(std::uint32_t index : part.indices)
+            {
+                builder.indices.push_back(base + index);
+            }
+        }
+
+        if(builder.vertices.size() < 3)
+        {
+            throw std::runtime_error{objPath.string() + " has no triangles!"};
+        }
+
+        return builder;
+    }
+
+    std::unique_ptr<Model> MeshLoader::loadModel(Device& device,
+                                                 JobSystem& jobSystem,
+                                                 const std::filesystem::path& objPath)
+    {
+        const MeshData mesh{loadMeshData(jobSystem, objPath)};
+        return std::make_unique<Model>(device, mesh.vertices, mesh.indices);
+    }
+
+    std::vector<std::unique_ptr<Model>> MeshLoader::loadModels(Device& device,
+                                                               JobSystem& jobSystem,
+                                                               std::span<const std::filesystem::path> objPaths)
+    {
+        // A big file's welding jobs spread over the workers that finished the small files
+        std::vector<MeshData> meshes(objPaths.size());
+        jobSystem.parallelFor(objPaths.size(), 1,
+                              [&](std::size_t begin, std::size_t end)
+                              {
+                                  for(std::size_t mesh{begin}; mesh < end; ++mesh)
+                                  {
+                                      meshes[mesh] = loadMeshData(jobSystem, objPaths[mesh]);
+                                  }
+                              });
+
+        std::vector<std::unique_ptr<Model>> models;
+        models.reserve(objPaths.size());
+
+        // Buffers are created in a fixed order, the upload itself is only recorded into the staging ring
+        for(const MeshData& mesh : meshes)
+        {
+            models.push_back(std::make_unique<Model>(device, mesh.vertices, mesh.indices));
+        }
+
+        return models;
+    }
+}
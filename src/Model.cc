@@ -1,27 +1,123 @@
 #include "Model.h"
+#include "StagingRing.h"
 
 // std
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace VE
 {
+    // Hashes the exact bits, welding only merges vertices that are really the same
+    struct VertexHash
+    {
+        std::size_t operator()(const Model::Vertex& vertex) const
+        {
+            const std::array<float, 6> components{vertex.position.x, vertex.position.y, vertex.position.z,
+                                                  vertex.color.x,    vertex.color.y,    vertex.color.z};
+
+            std::size_t seed{};
+            for(float component : components)
+            {
+                // + 0.0F turns -0.0F into 0.0F, they compare equal so they must hash equal
+                const auto bits{std::bit_cast<std::uint32_t>(component + 0.0F)};
+                seed ^= std::hash<std::uint32_t>{}(bits) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    };
+
     // Constructor
     Model::Model(Device& device, const std::vector<Vertex>& vertices)
-        : m_device{device}, m_vertexBuffer{}, m_vertexBufferMemory{}, m_vertexCount{}
+        : m_device{device},
+          m_vertexBuffer{},
+          m_vertexAllocation{},
+          m_vertexCount{},
+          m_indexBuffer{},
+          m_indexAllocation{},
+          m_indexCount{},
+          m_indexType{VK_INDEX_TYPE_UINT32},
+          m_boundingSphere{}
     {
         createVertexBuffers(vertices);
     }
 
+    // Constructor
+    Model::Model(Device& device, const Builder& builder) : Model{device, builder.vertices, builder.indices} {}
+
+    // Constructor
+    Model::Model(Device& device, std::span<const Vertex> vertices, std::span<const std::uint32_t> indices)
+        : m_device{device},
+          m_vertexBuffer{},
+          m_vertexAllocation{},
+          m_vertexCount{},
+          m_indexBuffer{},
+          m_indexAllocation{},
+          m_indexCount{},
+          m_indexType{VK_INDEX_TYPE_UINT32},
+          m_boundingSphere{}
+    {
+        try
+        {
+            createVertexBuffers(vertices);
+            createIndexBuffers(indices);
+        }
+        catch(...)
+        {
+            // The destructor never runs for a half built model, the vertex upload may still be queued as well
+            m_device.stagingRing().waitIdle();
+            destroyBuffers();
+            throw;
+        }
+    }
+
     // Destructor
     Model::~Model(void)
     {
-        vkDestroyBuffer(m_device.device(), m_vertexBuffer, nullptr);
-        vkFreeMemory(m_device.device(), m_vertexBufferMemory, nullptr);
+        destroyBuffers();
     }
 
+    void Model::destroyBuffers(void)
+    {
+        if(m_vertexBuffer)
+        {
+            m_device.destroyBuffer(m_vertexBuffer, m_vertexAllocation);
+        }
+
+        if(m_indexBuffer)
+        {
+            m_device.destroyBuffer(m_indexBuffer, m_indexAllocation);
+        }
+    }
+
+    Model::Builder Model::Builder::weld(const std::vector<Vertex>& triangleSoup)
+    {
+        Builder builder{};
+        builder.indices.reserve(triangleSoup.size());
+
+        std::unordered_map<Vertex, std::uint32_t, VertexHash> uniqueVertices;
+        uniqueVertices.reserve(triangleSoup.size());
+
+        for(const auto& vertex : triangleSoup)
+        {
+            const auto [unique, inserted]{
+                  uniqueVertices.try_emplace(vertex, static_cast<std::uint32_t>(builder.vertices.size()))};
+
+            if(inserted)
+            {
+                builder.vertices.push_back(vertex);
+            }
+            builder.indices.push_back(unique->second);
+        }
+
+        return builder;
+    }
 
     void Model::bind(VkCommandBuffer commandBuffer)
     {
@@ -29,11 +125,58 @@ namespace VE
         std::array<VkDeviceSize, 1> offsets{0};
 
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers.data(), offsets.data());
+
+        if(m_indexBuffer)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, m_indexType);
+        }
+    }
+
+    void Model::draw(VkCommandBuffer commandBuffer, std::uint32_t instanceCount, std::uint32_t firstInstance)
+    {
+        if(m_indexBuffer)
+        {
+            vkCmdDrawIndexed(commandBuffer, m_indexCount, instanceCount, 0, 0, firstInstance);
+        }
+        else
+        {
+            vkCmdDraw(commandBuffer, m_vertexCount, instanceCount, 0, firstInstance);
+        }
     }
 
-    void Model::draw(VkCommandBuffer commandBuffer) { vkCmdDraw(commandBuffer, m_vertexCount, 1, 0, 0); }
+    VkDrawIndexedIndirectCommand Model::getIndirectCommand(std::uint32_t instanceCount,
+                                                           std::uint32_t firstInstance) const
+    {
+        VkDrawIndexedIndirectCommand command{};
+        command.instanceCount = instanceCount;
 
-    void Model::createVertexBuffers(const std::vector<Vertex>& vertices)
+        if(m_indexBuffer)
+        {
+            command.indexCount = m_indexCount;
+            command.firstInstance = firstInstance;
+        }
+        else
+        {
+            // vertexCount, instanceCount, firstVertex, firstInstance
+            command.indexCount = m_vertexCount;
+            command.vertexOffset = static_cast<std::int32_t>(firstInstance);
+        }
+        return command;
+    }
+
+    void Model::drawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset)
+    {
+        if(m_indexBuffer)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+        }
+        else
+        {
+            vkCmdDrawIndirect(commandBuffer, buffer, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+
+    void Model::createVertexBuffers(std::span<const Vertex> vertices)
     {
         m_vertexCount = static_cast<std::uint32_t>(vertices.size());
 
@@ -42,16 +185,60 @@ namespace VE
             throw std::runtime_error{"At least we should have three vertices!"};
         }
 
+        // Centered on the bounding box, not minimal but tight enough for culling
+        glm::vec3 minimum{vertices[0].position};
+        glm::vec3 maximum{vertices[0].position};
+        for(const auto& vertex : vertices)
+        {
+            minimum = glm::min(minimum, vertex.position);
+            maximum = glm::max(maximum, vertex.position);
+        }
+
+        m_boundingSphere.center = (minimum + maximum) * 0.5F;
+        for(const auto& vertex : vertices)
+        {
+            const glm::vec3 offset{vertex.position - m_boundingSphere.center};
+            m_boundingSphere.radius = std::max(m_boundingSphere.radius, glm::dot(offset, offset));
+        }
+        m_boundingSphere.radius = std::sqrt(m_boundingSphere.radius);
+
         std::size_t bufferSize{sizeof(vertices[0]) * m_vertexCount};
 
-        m_device.createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-                              m_vertexBuffer, m_vertexBufferMemory);
+        // Vertex fetch from device local memory, the copy is submitted with the next staging flush
+        m_device.createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexAllocation);
+
+        m_device.stagingRing().upload(m_vertexBuffer, 0, vertices.data(), bufferSize);
+    }
+
+    void Model::createIndexBuffers(std::span<const std::uint32_t> indices)
+    {
+        m_indexCount = static_cast<std::uint32_t>(indices.size());
+
+        if(!m_indexCount)
+        {
+            return;
+        }
+
+        // Half the index bandwidth for everything up to 65536 vertices
+        const bool fitsIn16Bit{m_vertexCount <= std::numeric_limits<std::uint16_t>::max() + 1U};
+        m_indexType = fitsIn16Bit ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+        std::vector<std::uint16_t> shortIndices;
+        const void* data{indices.data()};
+        std::size_t bufferSize{sizeof(indices[0]) * m_indexCount};
+
+        if(fitsIn16Bit)
+        {
+            shortIndices.assign(indices.begin(), indices.end());
+            data = shortIndices.data();
+            bufferSize = sizeof(shortIndices[0]) * m_indexCount;
+        }
+
+        m_device.createBuffer(bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexBuffer, m_indexAllocation);
 
-        void* data{nullptr};
-        vkMapMemory(m_device.device(), m_vertexBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), static_cast<std::size_t>(bufferSize));
-        vkUnmapMemory(m_device.device(), m_vertexBufferMemory);
+        m_device.stagingRing().upload(m_indexBuffer, 0, data, bufferSize);
     }
 
     std::vector<VkVertexInputBindingDescription> Model::Vertex::getBindingDescriptions(void)
@@ -0,0 +1,134 @@
+#include "ParallelCommandRecorder.h"
+
+// std
+#include <stdexcept>
+
+namespace VE
+{
+    // Constructor
+    ParallelCommandRecorder::ParallelCommandRecorder(Device& device, JobSystem& jobSystem, std::uint32_t framesInFlight)
+        : m_device{device},
+          m_jobSystem{jobSystem},
+          m_frameIndex{},
+          m_threadFrames(jobSystem.getThreadCount(), std::vector<ThreadFrame>(framesInFlight)),
+          m_renderPass{},
+          m_framebuffer{},
+          m_extent{}
+    {
+        createThreadFrames();
+    }
+
+    // Destructor
+    ParallelCommandRecorder::~ParallelCommandRecorder(void)
+    {
+        // Takes every command buffer allocated from it along
+        for(auto& frames : m_threadFrames)
+        {
+            for(auto& frame : frames)
+            {
+                vkDestroyCommandPool(m_device.device(), frame.commandPool, nullptr);
+            }
+        }
+    }
+
+    void ParallelCommandRecorder::createThreadFrames(void)
+    {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = m_device.findPhysicalQueueFamilies().graphicsFamily.value();
+
+        // Reset as a whole once per frame, no RESET_COMMAND_BUFFER_BIT needed
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        for(auto& frames : m_threadFrames)
+        {
+            for(auto& frame : frames)
+            {
+                if(vkCreateCommandPool(m_device.device(), &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+                {
+                    throw std::runtime_error{"Failed to create recording thread command pool!"};
+                }
+            }
+        }
+    }
+
+    void ParallelCommandRecorder::beginFrame(std::uint32_t frameIndex)
+    {
+        m_frameIndex = frameIndex;
+
+        for(auto& frames : m_threadFrames)
+        {
+            ThreadFrame& frame{frames[m_frameIndex]};
+            vkResetCommandPool(m_device.device(), frame.commandPool, 0);
+            frame.used = 0;
+        }
+    }
+
+    void ParallelCommandRecorder::setRenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent)
+    {
+        m_renderPass = renderPass;
+        m_framebuffer = framebuffer;
+        m_extent = extent;
+    }
+
+    VkCommandBuffer ParallelCommandRecorder::beginSecondary(void)
+    {
+        // A worker only ever touches its own pool, so none of them needs a lock
+        ThreadFrame& frame{m_threadFrames[m_jobSystem.getThreadIndex()][m_frameIndex]};
+
+        if(frame.used == frame.commandBuffers.size())
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandPool = frame.commandPool;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer{};
+            if(vkAllocateCommandBuffers(m_device.device(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to allocate secondary command buffer!"};
+            }
+            frame.commandBuffers.push_back(commandBuffer);
+        }
+
+        VkCommandBuffer commandBuffer{frame.commandBuffers[frame.used++]};
+
+        VkCommandBufferInheritanceInfo inheritanceInfo{};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = m_renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = m_framebuffer;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to begin recording secondary command buffer!"};
+        }
+
+        // Dynamic state isn't inherited from the primary
+        VkViewport viewport{};
+        viewport.width = static_cast<float>(m_extent.width);
+        viewport.height = static_cast<float>(m_extent.height);
+        viewport.minDepth = 0.0F;
+        viewport.maxDepth = 1.0F;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor{{0, 0}, m_extent};
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        return commandBuffer;
+    }
+
+    void ParallelCommandRecorder::endSecondary(VkCommandBuffer commandBuffer)
+    {
+        if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to finish recording secondary command buffer!"};
+        }
+    }
+}
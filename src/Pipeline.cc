@@ -11,11 +11,11 @@
 namespace VE
 {
     // Constructor
-    Pipeline::Pipeline(Device& device, const std::string& vertFilePath, const std::string& fragFilePath,
+    Pipeline::Pipeline(Device& device, std::span<const std::uint32_t> vertCode, std::span<const std::uint32_t> fragCode,
                        const PipelineConfigInfo& configInfo)
         : m_device{device}, m_graphicsPipeline{}, m_vertShaderModule{}, m_fragShaderModule{}
     {
-        createGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
+        createGraphicsPipeline(vertCode, fragCode, configInfo);
     }
 
     // Destructor
@@ -27,7 +27,7 @@ namespace VE
         vkDestroyPipeline(m_device.device(), m_graphicsPipeline, nullptr);
     }
 
-    std::vector<char> Pipeline::readFile(const std::string& filePath)
+    std::vector<std::uint32_t> Pipeline::readSpirv(const std::string& filePath)
     {
         std::fstream file{filePath, std::ios::binary | std::ios::ate | std::ios::in};
 
@@ -37,17 +37,39 @@ namespace VE
         }
 
         std::streamsize fileSize{file.tellg()};
-        std::vector<char> buffer(static_cast<std::size_t>(fileSize));
+        if(fileSize <= 0 || fileSize % sizeof(std::uint32_t) != 0)
+        {
+            throw std::runtime_error{filePath + " isn't SPIR-V!"};
+        }
+
+        // Read as words, so the code is aligned the way vkCreateShaderModule wants it
+        std::vector<std::uint32_t> buffer(static_cast<std::size_t>(fileSize) / sizeof(std::uint32_t));
 
         file.seekg(0);
-        file.read(buffer.data(), fileSize);
+        file.read(reinterpret_cast<char*>(buffer.data()), fileSize);
 
         file.close();
         return buffer;
     }
 
-    void Pipeline::createGraphicsPipeline(const std::string& vertFilePath,
-                                          const std::string& fragFilePath,
+    VkShaderModule Pipeline::createShaderModule(Device& device, std::span<const std::uint32_t> code)
+    {
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size_bytes();
+        createInfo.pCode = code.data();
+
+        VkShaderModule shaderModule{VK_NULL_HANDLE};
+        if(vkCreateShaderModule(device.device(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create shader module!"};
+        }
+
+        return shaderModule;
+    }
+
+    void Pipeline::createGraphicsPipeline(std::span<const std::uint32_t> vertCode,
+                                          std::span<const std::uint32_t> fragCode,
                                           const PipelineConfigInfo& configInfo)
     {
         if(configInfo.pipelineLayout == VK_NULL_HANDLE)
@@ -60,11 +82,8 @@ namespace VE
             throw std::runtime_error{"Can't create graphics pipeline: no renderPass provided in configInfo"};
         }
 
-        std::vector<char> vertCode{Pipeline::readFile(vertFilePath)};
-        std::vector<char> fragCode{Pipeline::readFile(fragFilePath)};
-
-        createShaderModule(vertCode, &m_vertShaderModule);
-        createShaderModule(fragCode, &m_fragShaderModule);
+        m_vertShaderModule = createShaderModule(m_device, vertCode);
+        m_fragShaderModule = createShaderModule(m_device, fragCode);
 
         std::array<VkPipelineShaderStageCreateInfo, 2> shaderStagesInfos{};
 
@@ -87,8 +106,8 @@ namespace VE
         shaderStagesInfos[1].pSpecializationInfo = nullptr;
 
         // Vertex Input
-        auto bindingDescriptions{Model::Vertex::getBindingDescriptions()};
-        auto attributeDescriptions{Model::Vertex::getAttributeDescriptions()};
+        const auto& bindingDescriptions{configInfo.bindingDescriptions};
+        const auto& attributeDescriptions{configInfo.attributeDescriptions};
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -121,28 +140,19 @@ namespace VE
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if(vkCreateGraphicsPipelines(m_device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+        if(vkCreateGraphicsPipelines(m_device.device(), m_device.pipelineCache(), 1, &pipelineInfo, nullptr,
                                      &m_graphicsPipeline) != VK_SUCCESS)
         {
             throw std::runtime_error{"Failed to create the graphics pipeline!"};
         }
     }
 
-    void Pipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule)
-    {
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const std::uint32_t*>(code.data());
-
-        if(vkCreateShaderModule(m_device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS)
-        {
-            throw std::runtime_error{"Failed to create shader module!"};
-        }
-    }
-
     void Pipeline::defaultPipelineConfig(PipelineConfigInfo& configInfo)
     {
+        // Vertex Input
+        configInfo.bindingDescriptions = Model::Vertex::getBindingDescriptions();
+        configInfo.attributeDescriptions = Model::Vertex::getAttributeDescriptions();
+
         // Input Assembly Stage
         configInfo.inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
         configInfo.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -223,4 +233,51 @@ namespace VE
     {
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
     }
+
+    // Constructor
+    ComputePipeline::ComputePipeline(Device& device, std::span<const std::uint32_t> compCode,
+                                     VkPipelineLayout pipelineLayout)
+        : m_device{device}, m_computePipeline{}, m_compShaderModule{}
+    {
+        createComputePipeline(compCode, pipelineLayout);
+    }
+
+    // Destructor
+    ComputePipeline::~ComputePipeline(void)
+    {
+        vkDestroyShaderModule(m_device.device(), m_compShaderModule, nullptr);
+        vkDestroyPipeline(m_device.device(), m_computePipeline, nullptr);
+    }
+
+    void ComputePipeline::createComputePipeline(std::span<const std::uint32_t> compCode,
+                                                VkPipelineLayout pipelineLayout)
+    {
+        if(pipelineLayout == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error{"Can't create compute pipeline: no pipelineLayout provided"};
+        }
+
+        m_compShaderModule = Pipeline::createShaderModule(m_device, compCode);
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_compShaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        if(vkCreateComputePipelines(m_device.device(), m_device.pipelineCache(), 1, &pipelineInfo, nullptr,
+                                    &m_computePipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create the compute pipeline!"};
+        }
+    }
+
+    void ComputePipeline::bind(VkCommandBuffer commandBuffer)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+    }
 }
@@ -0,0 +1,198 @@
+#include "PipelineRegistry.h"
+
+// std
+#include <type_traits>
+#include <utility>
+
+namespace VE
+{
+    // Keys are compared byte by byte, so only values without padding go in. All the Vulkan structs appended
+    // whole are made of 32-bit members
+    template<typename T>
+    static void appendKey(std::string& key, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // What a pointer in a create info points to, a null pointer differs from an empty array
+    template<typename T>
+    static void appendKey(std::string& key, const T* values, std::size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        appendKey(key, count);
+        appendKey(key, values != nullptr);
+        if(values)
+        {
+            key.append(reinterpret_cast<const char*>(values), sizeof(T) * count);
+        }
+    }
+
+    static void appendCode(std::string& key, std::span<const std::uint32_t> code)
+    {
+        appendKey(key, code.data(), code.size());
+    }
+
+    // Constructor
+    PipelineRegistry::PipelineRegistry(Device& device) : m_device{device}, m_hitCount{}, m_missCount{}
+    {
+    }
+
+    std::string PipelineRegistry::makeKey(std::span<const std::uint32_t> vertCode,
+                                          std::span<const std::uint32_t> fragCode,
+                                          const PipelineConfigInfo& configInfo)
+    {
+        std::string key;
+
+        // Shaders by content, so a recompiled shader never matches the pipeline it replaces
+        appendCode(key, vertCode);
+        appendCode(key, fragCode);
+
+        // Vertex Input
+        appendKey(key, configInfo.bindingDescriptions.data(), configInfo.bindingDescriptions.size());
+        appendKey(key, configInfo.attributeDescriptions.data(), configInfo.attributeDescriptions.size());
+
+        // Input Assembly Stage
+        const auto& inputAssembly{configInfo.inputAssemblyInfo};
+        appendKey(key, inputAssembly.flags);
+        appendKey(key, inputAssembly.topology);
+        appendKey(key, inputAssembly.primitiveRestartEnable);
+
+        // Viewports & Scissors, usually dynamic
+        const auto& viewport{configInfo.viewportInfo};
+        appendKey(key, viewport.flags);
+        appendKey(key, viewport.pViewports, viewport.viewportCount);
+        appendKey(key, viewport.pScissors, viewport.scissorCount);
+
+        // Rasterization Stage
+        const auto& rasterization{configInfo.rasterizationInfo};
+        appendKey(key, rasterization.flags);
+        appendKey(key, rasterization.depthClampEnable);
+        appendKey(key, rasterization.rasterizerDiscardEnable);
+        appendKey(key, rasterization.polygonMode);
+        appendKey(key, rasterization.cullMode);
+        appendKey(key, rasterization.frontFace);
+        appendKey(key, rasterization.depthBiasEnable);
+        appendKey(key, rasterization.depthBiasConstantFactor);
+        appendKey(key, rasterization.depthBiasClamp);
+        appendKey(key, rasterization.depthBiasSlopeFactor);
+        appendKey(key, rasterization.lineWidth);
+
+        // Multisample, the sample mask has a bit per sample
+        const auto& multisample{configInfo.multisampleInfo};
+        const std::size_t sampleMaskWords{(static_cast<std::size_t>(multisample.rasterizationSamples) + 31) / 32};
+        appendKey(key, multisample.flags);
+        appendKey(key, multisample.rasterizationSamples);
+        appendKey(key, multisample.sampleShadingEnable);
+        appendKey(key, multisample.minSampleShading);
+        appendKey(key, multisample.pSampleMask, sampleMaskWords);
+        appendKey(key, multisample.alphaToCoverageEnable);
+        appendKey(key, multisample.alphaToOneEnable);
+
+        // Color blending, the attachments through the pointer the pipeline is created with
+        const auto& colorBlend{configInfo.colorBlendInfo};
+        appendKey(key, colorBlend.flags);
+        appendKey(key, colorBlend.logicOpEnable);
+        appendKey(key, colorBlend.logicOp);
+        appendKey(key, colorBlend.pAttachments, colorBlend.attachmentCount);
+        appendKey(key, colorBlend.blendConstants);
+
+        // Depth values comparison
+        const auto& depthStencil{configInfo.depthStencilInfo};
+        appendKey(key, depthStencil.flags);
+        appendKey(key, depthStencil.depthTestEnable);
+        appendKey(key, depthStencil.depthWriteEnable);
+        appendKey(key, depthStencil.depthCompareOp);
+        appendKey(key, depthStencil.depthBoundsTestEnable);
+        appendKey(key, depthStencil.stencilTestEnable);
+        appendKey(key, depthStencil.front);
+        appendKey(key, depthStencil.back);
+        appendKey(key, depthStencil.minDepthBounds);
+        appendKey(key, depthStencil.maxDepthBounds);
+
+        // Dynamic states
+        const auto& dynamicState{configInfo.dynamicStateInfo};
+        appendKey(key, dynamicState.flags);
+        appendKey(key, dynamicState.pDynamicStates, dynamicState.dynamicStateCount);
+
+        appendKey(key, configInfo.pipelineLayout);
+        appendKey(key, configInfo.renderPass);
+        appendKey(key, configInfo.subpass);
+
+        return key;
+    }
+
+    std::string PipelineRegistry::makeKey(std::span<const std::uint32_t> compCode, VkPipelineLayout pipelineLayout)
+    {
+        std::string key;
+        appendCode(key, compCode);
+        appendKey(key, pipelineLayout);
+
+        return key;
+    }
+
+    template<typename T, typename Create>
+    std::shared_ptr<T> PipelineRegistry::getOrCreate(std::unordered_map<std::string, std::weak_ptr<T>>& pipelines,
+                                                     std::string&& key,
+                                                     Create create)
+    {
+        // Held while compiling, so two threads asking for the same pipeline don't both build it
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        if(const auto entry{pipelines.find(key)}; entry != pipelines.end())
+        {
+            if(std::shared_ptr<T> pipeline{entry->second.lock()})
+            {
+                ++m_hitCount;
+                return pipeline;
+            }
+        }
+
+        ++m_missCount;
+
+        // Pipelines replaced by hot reload leave their entries behind
+        std::erase_if(pipelines, [](const auto& entry) { return entry.second.expired(); });
+
+        std::shared_ptr<T> pipeline{create()};
+        pipelines.insert_or_assign(std::move(key), pipeline);
+
+        return pipeline;
+    }
+
+    std::shared_ptr<Pipeline> PipelineRegistry::getPipeline(std::span<const std::uint32_t> vertCode,
+                                                            std::span<const std::uint32_t> fragCode,
+                                                            const PipelineConfigInfo& configInfo)
+    {
+        return getOrCreate(m_pipelines,
+                           makeKey(vertCode, fragCode, configInfo),
+                           [&] { return std::make_shared<Pipeline>(m_device, vertCode, fragCode, configInfo); });
+    }
+
+    std::shared_ptr<ComputePipeline> PipelineRegistry::getComputePipeline(std::span<const std::uint32_t> compCode,
+                                                                          VkPipelineLayout pipelineLayout)
+    {
+        return getOrCreate(m_computePipelines,
+                           makeKey(compCode, pipelineLayout),
+                           [&] { return std::make_shared<ComputePipeline>(m_device, compCode, pipelineLayout); });
+    }
+
+    PipelineRegistryStatistics PipelineRegistry::getStatistics(void)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        PipelineRegistryStatistics statistics{};
+        statistics.hitCount = m_hitCount;
+        statistics.missCount = m_missCount;
+
+        for(const auto& [key, pipeline] : m_pipelines)
+        {
+            statistics.pipelineCount += pipeline.expired() ? 0 : 1;
+        }
+        for(const auto& [key, pipeline] : m_computePipelines)
+        {
+            statistics.pipelineCount += pipeline.expired() ? 0 : 1;
+        }
+
+        return statistics;
+    }
+}
@@ -0,0 +1,778 @@
+#include "RenderGraph.h"
+
+// std
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace VE
+{
+    struct UsageInfo
+    {
+        VkPipelineStageFlags stages{};
+        VkAccessFlags access{};
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        VkImageUsageFlags imageUsage{};
+        bool write{};
+    };
+
+    static UsageInfo getUsageInfo(ResourceUsage usage)
+    {
+        switch(usage)
+        {
+            case ResourceUsage::ColorAttachment:
+                return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true};
+            case ResourceUsage::DepthAttachment:
+                return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                        true};
+            case ResourceUsage::FragmentSampled:
+                return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+            case ResourceUsage::ComputeSampled:
+                return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+            case ResourceUsage::VertexStorageRead:
+                return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                        VK_IMAGE_USAGE_STORAGE_BIT, false};
+            case ResourceUsage::ComputeStorageRead:
+                return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                        VK_IMAGE_USAGE_STORAGE_BIT, false};
+            case ResourceUsage::ComputeStorageWrite:
+                // Atomics read what they write
+                return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true};
+            case ResourceUsage::IndirectRead:
+                return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                        VK_IMAGE_LAYOUT_UNDEFINED, 0, false};
+            case ResourceUsage::TransferSrc:
+                return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false};
+            case ResourceUsage::TransferDst:
+                return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true};
+        }
+
+        throw std::runtime_error{"Unknown resource usage!"};
+    }
+
+    // Depth stencil formats have both aspects, barriers on them have to cover both
+    static VkImageAspectFlags getAspect(VkFormat format)
+    {
+        switch(format)
+        {
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    static bool isAttachment(ResourceUsage usage)
+    {
+        return usage == ResourceUsage::ColorAttachment || usage == ResourceUsage::DepthAttachment;
+    }
+
+    // Constructor
+    RenderGraph::RenderGraph(Device& device, VkExtent2D extent)
+        : m_device{device},
+          m_extent{extent},
+          m_compiled{}
+    {
+    }
+
+    // Destructor
+    RenderGraph::~RenderGraph(void)
+    {
+        collectRetiredResources(true);
+
+        for(auto& pass : m_passes)
+        {
+            vkDestroyFramebuffer(m_device.device(), pass.framebuffer, nullptr);
+            vkDestroyRenderPass(m_device.device(), pass.renderPass, nullptr);
+        }
+
+        for(auto& resource : m_resources)
+        {
+            if(isTransient(resource))
+            {
+                vkDestroyImageView(m_device.device(), resource.view, nullptr);
+                vkDestroyImage(m_device.device(), resource.image, nullptr);
+            }
+        }
+
+        // Freed once per slot, the images only borrowed it
+        for(auto& slot : m_memorySlots)
+        {
+            m_device.allocator().free(slot.allocation);
+        }
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::createImage(const std::string& name, const ImageDesc& desc)
+    {
+        Resource resource{};
+        resource.name = name;
+        resource.isImage = true;
+        resource.desc = desc;
+        resource.aspect = getAspect(desc.format);
+
+        m_resources.push_back(std::move(resource));
+        return static_cast<ResourceHandle>(m_resources.size() - 1);
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::importBuffer(const std::string& name)
+    {
+        Resource resource{};
+        resource.name = name;
+        resource.imported = true;
+
+        m_resources.push_back(std::move(resource));
+        return static_cast<ResourceHandle>(m_resources.size() - 1);
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::importImage(const std::string& name, VkFormat format)
+    {
+        Resource resource{};
+        resource.name = name;
+        resource.isImage = true;
+        resource.imported = true;
+        resource.aspect = getAspect(format);
+
+        m_resources.push_back(std::move(resource));
+        return static_cast<ResourceHandle>(m_resources.size() - 1);
+    }
+
+    void RenderGraph::markOutput(ResourceHandle resource) { m_resources[resource].output = true; }
+
+    RenderGraph::PassHandle RenderGraph::addPass(const std::string& name, PassCallback callback)
+    {
+        Pass pass{};
+        pass.name = name;
+        pass.callback = std::move(callback);
+
+        m_passes.push_back(std::move(pass));
+        return static_cast<PassHandle>(m_passes.size() - 1);
+    }
+
+    void RenderGraph::read(PassHandle pass, ResourceHandle resource, ResourceUsage usage)
+    {
+        m_passes[pass].accesses.push_back({resource, usage, false});
+    }
+
+    void RenderGraph::write(PassHandle pass, ResourceHandle resource, ResourceUsage usage)
+    {
+        m_passes[pass].accesses.push_back({resource, usage, true});
+    }
+
+    void RenderGraph::compile(void)
+    {
+        if(m_compiled)
+        {
+            throw std::runtime_error{"Render graph has already been compiled!"};
+        }
+
+        cullPasses();
+        computeLifetimes();
+        createTransientImages();
+        aliasTransientImages();
+
+        for(auto& pass : m_passes)
+        {
+            if(pass.live)
+            {
+                createRenderPass(pass);
+                createFramebuffer(pass);
+            }
+        }
+
+        m_compiled = true;
+    }
+
+    void RenderGraph::resize(VkExtent2D extent, std::uint64_t lastSubmittedFrame)
+    {
+        collectRetiredResources(false);
+
+        if(extent.width == m_extent.width && extent.height == m_extent.height)
+        {
+            return;
+        }
+        m_extent = extent;
+
+        // compile() creates everything at the new extent
+        if(!m_compiled)
+        {
+            return;
+        }
+
+        RetiredResources retired{};
+        retired.frameNumber = lastSubmittedFrame;
+
+        for(auto& pass : m_passes)
+        {
+            if(pass.framebuffer != VK_NULL_HANDLE)
+            {
+                retired.framebuffers.push_back(std::exchange(pass.framebuffer, VK_NULL_HANDLE));
+            }
+        }
+
+        for(auto& resource : m_resources)
+        {
+            if(isTransient(resource) && resource.image != VK_NULL_HANDLE)
+            {
+                retired.views.push_back(std::exchange(resource.view, VK_NULL_HANDLE));
+                retired.images.push_back(std::exchange(resource.image, VK_NULL_HANDLE));
+            }
+        }
+
+        for(auto& slot : m_memorySlots)
+        {
+            retired.allocations.push_back(slot.allocation);
+        }
+        m_memorySlots.clear();
+
+        m_retiredResources.push_back(std::move(retired));
+
+        // The render passes don't depend on the extent, only their framebuffers do
+        createTransientImages();
+        aliasTransientImages();
+
+        for(auto& pass : m_passes)
+        {
+            if(pass.renderPass != VK_NULL_HANDLE)
+            {
+                createFramebuffer(pass);
+            }
+        }
+    }
+
+    void RenderGraph::collectRetiredResources(bool waitAll)
+    {
+        if(m_retiredResources.empty())
+        {
+            return;
+        }
+
+        const std::uint64_t completedFrame{m_device.getCompletedFrame()};
+
+        // Retired in frame order, so everything done sits at the front
+        auto retired{m_retiredResources.begin()};
+        for(; retired != m_retiredResources.end() && (waitAll || retired->frameNumber <= completedFrame); ++retired)
+        {
+            if(retired->frameNumber > completedFrame)
+            {
+                m_device.waitForFrame(retired->frameNumber);
+            }
+
+            for(auto& framebuffer : retired->framebuffers)
+            {
+                vkDestroyFramebuffer(m_device.device(), framebuffer, nullptr);
+            }
+
+            for(std::size_t image{}; image < retired->images.size(); ++image)
+            {
+                vkDestroyImageView(m_device.device(), retired->views[image], nullptr);
+                vkDestroyImage(m_device.device(), retired->images[image], nullptr);
+            }
+
+            for(auto& allocation : retired->allocations)
+            {
+                m_device.allocator().free(allocation);
+            }
+        }
+        m_retiredResources.erase(m_retiredResources.begin(), retired);
+    }
+
+    void RenderGraph::cullPasses(void)
+    {
+        std::vector<bool> needed(m_resources.size());
+        for(std::size_t resource{}; resource < m_resources.size(); ++resource)
+        {
+            needed[resource] = m_resources[resource].output;
+        }
+
+        if(std::find(needed.begin(), needed.end(), true) == needed.end())
+        {
+            throw std::runtime_error{"Render graph has no outputs!"};
+        }
+
+        // Walking backwards every consumer is known before its producers are looked at. Resources stay needed
+        // once they are, an earlier writer still contributes when a later one only adds to the contents
+        for(auto pass{m_passes.rbegin()}; pass != m_passes.rend(); ++pass)
+        {
+            pass->live = std::any_of(pass->accesses.begin(), pass->accesses.end(),
+                                     [&](const Access& access) { return access.write && needed[access.resource]; });
+            if(!pass->live)
+            {
+                continue;
+            }
+
+            for(const auto& access : pass->accesses)
+            {
+                if(!access.write)
+                {
+                    needed[access.resource] = true;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::computeLifetimes(void)
+    {
+        for(std::size_t passIndex{}; passIndex < m_passes.size(); ++passIndex)
+        {
+            if(!m_passes[passIndex].live)
+            {
+                continue;
+            }
+
+            for(const auto& access : m_passes[passIndex].accesses)
+            {
+                Resource& resource{m_resources[access.resource]};
+                if(!isTransient(resource))
+                {
+                    continue;
+                }
+
+                resource.firstPass = std::min(resource.firstPass, passIndex);
+                resource.lastPass = std::max(resource.lastPass, passIndex);
+                resource.imageUsage |= getUsageInfo(access.usage).imageUsage;
+            }
+        }
+    }
+
+    void RenderGraph::createTransientImages(void)
+    {
+        for(auto& resource : m_resources)
+        {
+            if(!isTransient(resource) || resource.firstPass == NO_PASS)
+            {
+                continue;
+            }
+
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width = m_extent.width;
+            imageInfo.extent.height = m_extent.height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = resource.desc.format;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = resource.imageUsage;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            // Memory is bound after aliasing, once the sizes of all images are known
+            if(vkCreateImage(m_device.device(), &imageInfo, nullptr, &resource.image) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to create transient image " + resource.name + "!"};
+            }
+            vkGetImageMemoryRequirements(m_device.device(), resource.image, &resource.requirements);
+        }
+    }
+
+    void RenderGraph::aliasTransientImages(void)
+    {
+        std::vector<ResourceHandle> images;
+        for(std::size_t resource{}; resource < m_resources.size(); ++resource)
+        {
+            if(isTransient(m_resources[resource]) && m_resources[resource].image != VK_NULL_HANDLE)
+            {
+                images.push_back(static_cast<ResourceHandle>(resource));
+            }
+        }
+
+        // Biggest first, smaller images then fit into the slots they leave
+        std::sort(images.begin(), images.end(), [&](ResourceHandle left, ResourceHandle right)
+                  { return m_resources[left].requirements.size > m_resources[right].requirements.size; });
+
+        const auto overlaps{[&](const Resource& left, const Resource& right)
+                            { return left.firstPass <= right.lastPass && right.firstPass <= left.lastPass; }};
+
+        for(const auto handle : images)
+        {
+            Resource& image{m_resources[handle]};
+
+            auto slot{std::find_if(m_memorySlots.begin(), m_memorySlots.end(),
+                                   [&](const MemorySlot& candidate)
+                                   {
+                                       return (candidate.requirements.memoryTypeBits &
+                                               image.requirements.memoryTypeBits) != 0 &&
+                                              std::none_of(candidate.images.begin(), candidate.images.end(),
+                                                           [&](ResourceHandle other)
+                                                           { return overlaps(image, m_resources[other]); });
+                                   })};
+
+            if(slot == m_memorySlots.end())
+            {
+                m_memorySlots.emplace_back();
+                slot = std::prev(m_memorySlots.end());
+                slot->requirements = image.requirements;
+            }
+            else
+            {
+                slot->requirements.size = std::max(slot->requirements.size, image.requirements.size);
+                slot->requirements.alignment = std::max(slot->requirements.alignment, image.requirements.alignment);
+                slot->requirements.memoryTypeBits &= image.requirements.memoryTypeBits;
+            }
+
+            image.memorySlot = static_cast<std::size_t>(slot - m_memorySlots.begin());
+            slot->images.push_back(handle);
+        }
+
+        for(auto& slot : m_memorySlots)
+        {
+            slot.allocation = m_device.allocator().allocate(slot.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                            ResourceKind::Optimal);
+
+            for(const auto handle : slot.images)
+            {
+                Resource& image{m_resources[handle]};
+                if(vkBindImageMemory(m_device.device(), image.image, slot.allocation.memory, slot.allocation.offset) !=
+                   VK_SUCCESS)
+                {
+                    throw std::runtime_error{"Failed to bind transient image memory!"};
+                }
+
+                VkImageViewCreateInfo viewInfo{};
+                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                viewInfo.image = image.image;
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = image.desc.format;
+                viewInfo.subresourceRange.aspectMask = image.aspect;
+                viewInfo.subresourceRange.baseMipLevel = 0;
+                viewInfo.subresourceRange.levelCount = 1;
+                viewInfo.subresourceRange.baseArrayLayer = 0;
+                viewInfo.subresourceRange.layerCount = 1;
+
+                if(vkCreateImageView(m_device.device(), &viewInfo, nullptr, &image.view) != VK_SUCCESS)
+                {
+                    throw std::runtime_error{"Failed to create transient image view!"};
+                }
+            }
+        }
+    }
+
+    void RenderGraph::createRenderPass(Pass& pass)
+    {
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<VkAttachmentReference> colorReferences;
+        std::optional<VkAttachmentReference> depthReference;
+
+        const auto passIndex{static_cast<std::size_t>(&pass - m_passes.data())};
+
+        for(const auto& access : pass.accesses)
+        {
+            // Imported attachments are the callback's business, it begins the render pass for all of them then
+            if(isAttachment(access.usage) && m_resources[access.resource].imported)
+            {
+                pass.attachments.clear();
+                pass.clearValues.clear();
+                return;
+            }
+
+            if(!isAttachment(access.usage))
+            {
+                continue;
+            }
+
+            const Resource& resource{m_resources[access.resource]};
+            const UsageInfo info{getUsageInfo(access.usage)};
+
+            // The barriers before the pass do the layout transitions, the render pass keeps the layout
+            VkAttachmentDescription attachment{};
+            attachment.format = resource.desc.format;
+            attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            // Cleared by its first pass, stored only if a later pass still needs it
+            attachment.loadOp =
+                  resource.firstPass == passIndex ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+            attachment.storeOp =
+                  resource.lastPass == passIndex ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.initialLayout = info.layout;
+            attachment.finalLayout = info.layout;
+
+            const VkAttachmentReference reference{static_cast<std::uint32_t>(attachments.size()), info.layout};
+            if(access.usage == ResourceUsage::DepthAttachment)
+            {
+                depthReference = reference;
+            }
+            else
+            {
+                colorReferences.push_back(reference);
+            }
+
+            attachments.push_back(attachment);
+            pass.attachments.push_back(access.resource);
+            pass.clearValues.push_back(resource.desc.clearValue);
+        }
+
+        if(attachments.empty())
+        {
+            return;
+        }
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<std::uint32_t>(colorReferences.size());
+        subpass.pColorAttachments = colorReferences.data();
+        subpass.pDepthStencilAttachment = depthReference ? &depthReference.value() : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<std::uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        if(vkCreateRenderPass(m_device.device(), &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create render pass for " + pass.name + "!"};
+        }
+    }
+
+    void RenderGraph::createFramebuffer(Pass& pass)
+    {
+        if(pass.renderPass == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        std::vector<VkImageView> views;
+        views.reserve(pass.attachments.size());
+        for(const auto attachment : pass.attachments)
+        {
+            views.push_back(m_resources[attachment].view);
+        }
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = pass.renderPass;
+        framebufferInfo.attachmentCount = static_cast<std::uint32_t>(views.size());
+        framebufferInfo.pAttachments = views.data();
+        framebufferInfo.width = m_extent.width;
+        framebufferInfo.height = m_extent.height;
+        framebufferInfo.layers = 1;
+
+        if(vkCreateFramebuffer(m_device.device(), &framebufferInfo, nullptr, &pass.framebuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create framebuffer for " + pass.name + "!"};
+        }
+    }
+
+    void RenderGraph::setBuffer(ResourceHandle resource, VkBuffer buffer) { m_resources[resource].buffer = buffer; }
+
+    void RenderGraph::setImage(ResourceHandle resource, VkImage image, VkImageLayout layout)
+    {
+        m_resources[resource].image = image;
+        m_resources[resource].importedLayout = layout;
+    }
+
+    void RenderGraph::transition(const Access& access, VkPipelineStageFlags& srcStages, VkPipelineStageFlags& dstStages)
+    {
+        Resource& resource{m_resources[access.resource]};
+        if(resource.isImage ? resource.image == VK_NULL_HANDLE : resource.buffer == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        ResourceState& state{resource.state};
+        if(isTransient(resource) && resource.firstUse)
+        {
+            // The contents of the image that had the memory before are garbage to this one, but its accesses
+            // still have to finish before they get overwritten
+            state = m_memorySlots[resource.memorySlot].state;
+            state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            resource.firstUse = false;
+        }
+
+        const UsageInfo info{getUsageInfo(access.usage)};
+        const VkImageLayout oldLayout{state.layout};
+        const VkImageLayout layout{resource.isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED};
+        const bool layoutChange{layout != oldLayout};
+
+        VkPipelineStageFlags waitStages{};
+        VkAccessFlags srcAccess{};
+        bool needsBarrier{};
+
+        if(info.write || layoutChange)
+        {
+            // Waits for everything since the last write, reads included, write after read only needs the order
+            waitStages = state.writeStages | state.readStages;
+            srcAccess = state.writeAccess;
+            needsBarrier = srcAccess != 0 || layoutChange;
+
+            state.writeStages = info.stages;
+            state.writeAccess = info.write ? info.access : 0;
+            state.readStages = info.write ? 0 : info.stages;
+            state.visibleStages = info.write ? 0 : info.stages;
+            state.visibleAccess = info.write ? 0 : info.access;
+            state.layout = layout;
+        }
+        else
+        {
+            // Reads after reads are free, only the first read of each kind after a write waits for it
+            const bool visible{(info.stages & ~state.visibleStages) == 0 && (info.access & ~state.visibleAccess) == 0};
+            if(state.writeStages != 0 && !visible)
+            {
+                waitStages = state.writeStages;
+                srcAccess = state.writeAccess;
+                needsBarrier = true;
+            }
+
+            state.readStages |= info.stages;
+            state.visibleStages |= info.stages;
+            state.visibleAccess |= info.access;
+        }
+
+        if(waitStages != 0 || needsBarrier)
+        {
+            srcStages |= waitStages;
+            dstStages |= info.stages;
+        }
+
+        if(needsBarrier && resource.isImage)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = info.access;
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = layout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = resource.image;
+            barrier.subresourceRange.aspectMask = resource.aspect;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.layerCount = 1;
+            m_imageBarriers.push_back(barrier);
+        }
+        else if(needsBarrier)
+        {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = info.access;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = resource.buffer;
+            barrier.size = VK_WHOLE_SIZE;
+            m_bufferBarriers.push_back(barrier);
+        }
+
+        if(isTransient(resource))
+        {
+            m_memorySlots[resource.memorySlot].state = state;
+        }
+    }
+
+    void RenderGraph::execute(FrameInfo& frameInfo)
+    {
+        if(!m_compiled)
+        {
+            throw std::runtime_error{"Render graph has to be compiled before it is executed!"};
+        }
+
+        for(auto& resource : m_resources)
+        {
+            if(resource.imported)
+            {
+                resource.state = ResourceState{};
+                resource.state.layout = resource.importedLayout;
+            }
+            else
+            {
+                resource.firstUse = true;
+            }
+        }
+
+        for(auto& pass : m_passes)
+        {
+            if(!pass.live)
+            {
+                continue;
+            }
+
+            m_imageBarriers.clear();
+            m_bufferBarriers.clear();
+            VkPipelineStageFlags srcStages{};
+            VkPipelineStageFlags dstStages{};
+
+            for(const auto& access : pass.accesses)
+            {
+                transition(access, srcStages, dstStages);
+            }
+
+            // One barrier for the whole pass, nothing at all if every access was already safe
+            if(dstStages != 0)
+            {
+                vkCmdPipelineBarrier(frameInfo.commandBuffer,
+                                     srcStages != 0 ? srcStages : VkPipelineStageFlags{VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT},
+                                     dstStages,
+                                     0,
+                                     0,
+                                     nullptr,
+                                     static_cast<std::uint32_t>(m_bufferBarriers.size()),
+                                     m_bufferBarriers.data(),
+                                     static_cast<std::uint32_t>(m_imageBarriers.size()),
+                                     m_imageBarriers.data());
+            }
+
+            if(pass.renderPass == VK_NULL_HANDLE)
+            {
+                pass.callback(frameInfo);
+                continue;
+            }
+
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass = pass.renderPass;
+            renderPassInfo.framebuffer = pass.framebuffer;
+            renderPassInfo.renderArea.offset = {0, 0};
+            renderPassInfo.renderArea.extent = m_extent;
+            renderPassInfo.clearValueCount = static_cast<std::uint32_t>(pass.clearValues.size());
+            renderPassInfo.pClearValues = pass.clearValues.data();
+
+            vkCmdBeginRenderPass(frameInfo.commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            pass.callback(frameInfo);
+            vkCmdEndRenderPass(frameInfo.commandBuffer);
+        }
+    }
+
+    VkDeviceSize RenderGraph::getTransientMemorySize(void) const
+    {
+        return std::accumulate(m_memorySlots.begin(), m_memorySlots.end(), VkDeviceSize{},
+                               [](VkDeviceSize sum, const MemorySlot& slot) { return sum + slot.requirements.size; });
+    }
+
+    VkDeviceSize RenderGraph::getUnaliasedMemorySize(void) const
+    {
+        VkDeviceSize size{};
+        for(const auto& resource : m_resources)
+        {
+            if(isTransient(resource) && resource.image != VK_NULL_HANDLE)
+            {
+                size += resource.requirements.size;
+            }
+        }
+        return size;
+    }
+}
+
@@ -1,24 +1,47 @@
 #include "Renderer.h"
+#include "StagingRing.h"
 
 // std
 #include <array>
 #include <cstdio>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 namespace VE
 {
-    struct SimplePushConstantData
-    {
-        glm::mat2 transform{1.0F};
-        glm::vec2 offset;
-        alignas(16) glm::vec3 color;
-    };
-
     // Constructor
-    Renderer::Renderer(Window& window, Device& device)
-        : m_window{window}, m_device{device}, m_currentImageIndex{}, m_isFrameStarted{}, m_currentFrameIndex{}
+    Renderer::Renderer(Window& window,
+                       Device& device,
+                       JobSystem& jobSystem,
+                       std::uint32_t framesInFlight,
+                       VkPresentModeKHR presentMode)
+        : m_window{window},
+          m_device{device},
+          m_gpuProfiler{device, framesInFlight},
+          m_presentMode{presentMode},
+          m_commandRecorder{device, jobSystem, framesInFlight},
+          m_currentImageIndex{},
+          m_isFrameStarted{},
+          m_framesInFlight{framesInFlight},
+          m_currentFrameIndex{},
+          m_frameNumber{},
+          m_frameScope{GpuProfiler::INVALID_SCOPE},
+          m_renderPassScope{GpuProfiler::INVALID_SCOPE}
     {
+        if(framesInFlight == 0 || framesInFlight > SwapChain::MAX_FRAMES_IN_FLIGHT)
+        {
+            throw std::runtime_error{"Frames in flight must be between 1 and " +
+                                     std::to_string(SwapChain::MAX_FRAMES_IN_FLIGHT) + "!"};
+        }
+
+        // FrameArena can't be moved, one allocation each
+        m_frameArenas.reserve(framesInFlight);
+        for(std::uint32_t i{}; i < framesInFlight; ++i)
+        {
+            m_frameArenas.push_back(std::make_unique<FrameArena>());
+        }
+
         recreateSwapChain();
         createCommandBuffers();
     }
@@ -35,29 +58,21 @@ namespace VE
             extent = m_window.getExtent();
             glfwWaitEvents();
         }
-        vkDeviceWaitIdle(m_device.device());
 
         if(m_swapChain == nullptr)
         {
-            m_swapChain = std::make_unique<SwapChain>(m_device, m_window.getExtent());
+            m_swapChain = std::make_unique<SwapChain>(m_device, extent, m_framesInFlight, m_presentMode);
         }
         else
         {
-            std::shared_ptr<SwapChain> oldSwapChain{std::move(m_swapChain)};
-
-            m_swapChain = std::make_unique<SwapChain>(m_device, m_window.getExtent(), oldSwapChain);
-
-            if(!oldSwapChain->compareSwapChainFormats(*m_swapChain))
-            {
-                // TODO: Notify the app about the new incompatible render pass has been created
-                throw std::runtime_error{"Swap chain image/depth format has changed!"};
-            }
+            // No device wait, the swap chain keeps its render pass and retires the old images on the frame timeline
+            m_swapChain->recreate(extent);
         }
     }
 
     void Renderer::createCommandBuffers(void)
     {
-        m_commandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        m_commandBuffers.resize(m_framesInFlight);
 
         // Allocate command buffers
         VkCommandBufferAllocateInfo allocInfo{};
@@ -86,6 +101,15 @@ namespace VE
             throw std::runtime_error{"Can't call beginFrame(void) while already in progress"};
         }
 
+        // The frame that used this frame slot last has to be finished before anything of the slot is reused
+        if(m_frameNumber >= m_framesInFlight)
+        {
+            m_device.waitForFrame(m_frameNumber + 1 - m_framesInFlight);
+        }
+
+        // Uploads recorded since the last frame go first in queue order, the frame can use them right away
+        m_device.stagingRing().flush();
+
         auto result{m_swapChain->acquireNextImage(&m_currentImageIndex)};
         if(result == VK_ERROR_OUT_OF_DATE_KHR)
         {
@@ -108,6 +132,14 @@ namespace VE
         {
             throw std::runtime_error("failed to begin recording command buffer!");
         }
+
+        // The frame timeline wait above covers this slot, so its previous timestamps are ready
+        // and its secondary command buffers and transient allocations can be recycled
+        m_commandRecorder.beginFrame(m_currentFrameIndex);
+        m_frameArenas[m_currentFrameIndex]->reset();
+        m_gpuProfiler.beginFrame(commandBuffer, m_currentFrameIndex);
+        m_frameScope = m_gpuProfiler.beginScope(commandBuffer, "gpuFrame");
+
         return commandBuffer;
     }
 
@@ -120,12 +152,15 @@ namespace VE
 
         auto commandBuffer{getCurrentCommandBuffer()};
 
+        m_gpuProfiler.endScope(commandBuffer, m_frameScope);
+
         if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
         {
             throw std::runtime_error{"Failed to finish recording command buffer!"};
         }
 
-        auto result{m_swapChain->submitCommandBuffers(&commandBuffer, &m_currentImageIndex)};
+        ++m_frameNumber;
+        auto result{m_swapChain->submitCommandBuffers(&commandBuffer, &m_currentImageIndex, m_frameNumber)};
 
         if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_window.wasWindowResized())
         {
@@ -138,10 +173,10 @@ namespace VE
         }
 
         m_isFrameStarted = false;
-        m_currentFrameIndex = (m_currentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+        m_currentFrameIndex = (m_currentFrameIndex + 1) % m_framesInFlight;
     }
 
-    void Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer)
+    void Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkImageView depthView)
     {
         if(!m_isFrameStarted)
         {
@@ -157,7 +192,7 @@ namespace VE
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassInfo.renderPass = m_swapChain->getRenderPass();
-        renderPassInfo.framebuffer = m_swapChain->getFrameBuffer(m_currentImageIndex);
+        renderPassInfo.framebuffer = m_swapChain->getFrameBuffer(m_currentImageIndex, depthView);
 
         renderPassInfo.renderArea.offset = {0, 0};
         renderPassInfo.renderArea.extent = m_swapChain->getSwapChainExtent();
@@ -169,19 +204,12 @@ namespace VE
         renderPassInfo.clearValueCount = static_cast<std::uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport{};
-        viewport.x = 0.0F;
-        viewport.y = 0.0F;
-        viewport.width = static_cast<float>(m_swapChain->getSwapChainExtent().width);
-        viewport.height = static_cast<float>(m_swapChain->getSwapChainExtent().height);
-        viewport.minDepth = 0.0F;
-        viewport.maxDepth = 1.0F;
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        m_renderPassScope = m_gpuProfiler.beginScope(commandBuffer, "swapChainRenderPass");
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-        VkRect2D scissor{{0, 0}, m_swapChain->getSwapChainExtent()};
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        // Only vkCmdExecuteCommands() is allowed in here now, viewport and scissor are set by every secondary
+        m_commandRecorder.setRenderPass(renderPassInfo.renderPass, renderPassInfo.framebuffer,
+                                        renderPassInfo.renderArea.extent);
     }
 
     void Renderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer)
@@ -198,6 +226,7 @@ namespace VE
         }
 
         vkCmdEndRenderPass(commandBuffer);
+        m_gpuProfiler.endScope(commandBuffer, m_renderPassScope);
     }
 
     [[nodiscard]] VkCommandBuffer Renderer::getCurrentCommandBuffer(void) const
@@ -0,0 +1,433 @@
+#include "Scene.h"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// SIMD
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace VE
+{
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    // The same kernel is instantiated for 4 (SSE) and 8 (AVX) lanes, this maps the handful of ops it needs
+    struct Sse
+    {
+        using V = __m128;
+        static constexpr std::size_t LANES{4};
+
+        static __m128 load(const float* data) { return _mm_loadu_ps(data); }
+        static __m128 set1(float value) { return _mm_set1_ps(value); }
+        static __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+        static __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+        static __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+        static __m128 round(__m128 a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+        static __m128 equal(__m128 a, __m128 b) { return _mm_cmpeq_ps(a, b); }
+        static __m128 bitOr(__m128 a, __m128 b) { return _mm_or_ps(a, b); }
+        static __m128 bitXor(__m128 a, __m128 b) { return _mm_xor_ps(a, b); }
+        static __m128 bitAnd(__m128 a, __m128 b) { return _mm_and_ps(a, b); }
+        static __m128 select(__m128 mask, __m128 a, __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+        static void store(float* data, __m128 a) { _mm_storeu_ps(data, a); }
+    };
+
+#if defined(__AVX__)
+    struct Avx
+    {
+        using V = __m256;
+        static constexpr std::size_t LANES{8};
+
+        static __m256 load(const float* data) { return _mm256_loadu_ps(data); }
+        static __m256 set1(float value) { return _mm256_set1_ps(value); }
+        static __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+        static __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+        static __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+        static __m256 round(__m256 a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static __m256 equal(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static __m256 bitOr(__m256 a, __m256 b) { return _mm256_or_ps(a, b); }
+        static __m256 bitXor(__m256 a, __m256 b) { return _mm256_xor_ps(a, b); }
+        static __m256 bitAnd(__m256 a, __m256 b) { return _mm256_and_ps(a, b); }
+        static __m256 select(__m256 mask, __m256 a, __m256 b) { return _mm256_blendv_ps(b, a, mask); }
+        static void store(float* data, __m256 a) { _mm256_storeu_ps(data, a); }
+    };
+#endif
+
+    // Cephes style: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2, then pick and negate by quadrant
+    template<typename S, typename V = typename S::V>
+    static void sinCos(V angle, V& sine, V& cosine)
+    {
+        const V quadrant{S::round(S::mul(angle, S::set1(0.636619772F)))};
+
+        // pi/2 split into three parts so the reduction stays exact for the angles we deal with
+        V x{S::sub(angle, S::mul(quadrant, S::set1(1.5703125F)))};
+        x = S::sub(x, S::mul(quadrant, S::set1(4.837512969970703125e-4F)));
+        x = S::sub(x, S::mul(quadrant, S::set1(7.54978995489188216e-8F)));
+
+        const V x2{S::mul(x, x)};
+
+        V sinPoly{S::add(S::mul(S::set1(-1.9515295891e-4F), x2), S::set1(8.3321608736e-3F))};
+        sinPoly = S::add(S::mul(sinPoly, x2), S::set1(-1.6666654611e-1F));
+        sinPoly = S::add(S::mul(S::mul(sinPoly, x2), x), x);
+
+        V cosPoly{S::add(S::mul(S::set1(2.443315711809948e-5F), x2), S::set1(-1.388731625493765e-3F))};
+        cosPoly = S::add(S::mul(cosPoly, x2), S::set1(4.166664568298827e-2F));
+        cosPoly = S::add(S::sub(S::mul(S::mul(cosPoly, x2), x2), S::mul(x2, S::set1(0.5F))), S::set1(1.0F));
+
+        // quadrant mod 4 in [-2, 2], -1 is the same quadrant as 3 and -2 the same as 2
+        const V q{S::sub(quadrant, S::mul(S::round(S::mul(quadrant, S::set1(0.25F))), S::set1(4.0F)))};
+        const V isOne{S::equal(q, S::set1(1.0F))};
+        const V isMinusOne{S::equal(q, S::set1(-1.0F))};
+        const V isTwo{S::bitOr(S::equal(q, S::set1(2.0F)), S::equal(q, S::set1(-2.0F)))};
+
+        const V swap{S::bitOr(isOne, isMinusOne)};
+        const V signBit{S::set1(-0.0F)};
+
+        sine = S::select(swap, cosPoly, sinPoly);
+        cosine = S::select(swap, sinPoly, cosPoly);
+
+        sine = S::bitXor(sine, S::bitAnd(S::bitOr(isTwo, isMinusOne), signBit));
+        cosine = S::bitXor(cosine, S::bitAnd(S::bitOr(isTwo, isOne), signBit));
+    }
+
+    // Closed form of translate * rotateY * rotateX * rotateZ * scale, written column by column
+    template<typename S>
+    static void computeLocalMatrices(const float* const* components, std::size_t first, glm::mat4* matrices)
+    {
+        using V = typename S::V;
+        constexpr std::size_t LANES{S::LANES};
+
+        V s1{}, c1{}, s2{}, c2{}, s3{}, c3{};
+        sinCos<S>(S::load(components[4] + first), s1, c1);  // y
+        sinCos<S>(S::load(components[3] + first), s2, c2);  // x
+        sinCos<S>(S::load(components[5] + first), s3, c3);  // z
+
+        const V scaleX{S::load(components[6] + first)};
+        const V scaleY{S::load(components[7] + first)};
+        const V scaleZ{S::load(components[8] + first)};
+
+        // 12 of the 16 entries, the rest are constants
+        std::array<std::array<float, LANES>, 12> entries{};
+
+        const V s2s3{S::mul(s2, s3)};
+        const V c3s2{S::mul(c3, s2)};
+
+        S::store(entries[0].data(), S::mul(scaleX, S::add(S::mul(c1, c3), S::mul(s1, s2s3))));
+        S::store(entries[1].data(), S::mul(scaleX, S::mul(c2, s3)));
+        S::store(entries[2].data(), S::mul(scaleX, S::sub(S::mul(c1, s2s3), S::mul(c3, s1))));
+
+        S::store(entries[3].data(), S::mul(scaleY, S::sub(S::mul(c3s2, s1), S::mul(c1, s3))));
+        S::store(entries[4].data(), S::mul(scaleY, S::mul(c2, c3)));
+        S::store(entries[5].data(), S::mul(scaleY, S::add(S::mul(c1, c3s2), S::mul(s1, s3))));
+
+        S::store(entries[6].data(), S::mul(scaleZ, S::mul(c2, s1)));
+        S::store(entries[7].data(), S::sub(S::set1(0.0F), S::mul(scaleZ, s2)));
+        S::store(entries[8].data(), S::mul(scaleZ, S::mul(c1, c2)));
+
+        S::store(entries[9].data(), S::load(components[0] + first));
+        S::store(entries[10].data(), S::load(components[1] + first));
+        S::store(entries[11].data(), S::load(components[2] + first));
+
+        for(std::size_t lane{}; lane < LANES; ++lane)
+        {
+            glm::mat4& matrix{matrices[first + lane]};
+            for(std::size_t column{}; column < 4; ++column)
+            {
+                matrix[static_cast<glm::length_t>(column)] =
+                      glm::vec4{entries[column * 3][lane], entries[column * 3 + 1][lane], entries[column * 3 + 2][lane],
+                                column == 3 ? 1.0F : 0.0F};
+            }
+        }
+    }
+#endif
+
+    void Scene::reserve(std::size_t objectCount)
+    {
+        for(auto* component : {&m_translationX, &m_translationY, &m_translationZ, &m_rotationX, &m_rotationY,
+                               &m_rotationZ, &m_scaleX, &m_scaleY, &m_scaleZ})
+        {
+            component->reserve(objectCount);
+        }
+
+        m_colors.reserve(objectCount);
+        m_parents.reserve(objectCount);
+        m_localMatrices.reserve(objectCount);
+        m_worldMatrices.reserve(objectCount);
+        m_localDirty.reserve(objectCount);
+        m_worldDirty.reserve(objectCount);
+        m_updateOrder.reserve(objectCount);
+        m_models.reserve(objectCount);
+    }
+
+    Scene::ObjectId Scene::createObject(std::shared_ptr<Model> model,
+                                        const TransformComponent& transform,
+                                        glm::vec3 color,
+                                        ObjectId parent)
+    {
+        // Checked before anything is added, so a bad parent leaves no half created object behind
+        if(parent != NO_PARENT && parent >= size())
+        {
+            throw std::runtime_error{"Parent object " + std::to_string(parent) + " doesn't exist!"};
+        }
+
+        const auto object{static_cast<ObjectId>(m_models.size())};
+
+        m_translationX.push_back(transform.translation.x);
+        m_translationY.push_back(transform.translation.y);
+        m_translationZ.push_back(transform.translation.z);
+        m_rotationX.push_back(transform.rotation.x);
+        m_rotationY.push_back(transform.rotation.y);
+        m_rotationZ.push_back(transform.rotation.z);
+        m_scaleX.push_back(transform.scale.x);
+        m_scaleY.push_back(transform.scale.y);
+        m_scaleZ.push_back(transform.scale.z);
+
+        m_colors.push_back(color);
+        m_parents.push_back(NO_PARENT);
+        m_localMatrices.push_back(transform.mat4());
+        m_worldMatrices.push_back(m_localMatrices.back());
+        m_localDirty.push_back(0);
+        m_worldDirty.push_back(1);
+        m_updateOrder.push_back(object);
+        m_anyDirty = true;
+        m_hierarchyChanged = true;
+        ++m_version;
+
+        m_models.push_back(model.get());
+        if(model)
+        {
+            m_ownedModels.try_emplace(model.get(), std::move(model));
+        }
+
+        if(parent != NO_PARENT)
+        {
+            setParent(object, parent);
+        }
+
+        return object;
+    }
+
+    void Scene::markDirty(ObjectId object)
+    {
+        m_localDirty[object] = 1;
+        m_anyDirty = true;
+    }
+
+    void Scene::setParent(ObjectId child, ObjectId parent)
+    {
+        if(child >= size())
+        {
+            throw std::runtime_error{"Object " + std::to_string(child) + " doesn't exist!"};
+        }
+
+        if(parent != NO_PARENT && parent >= size())
+        {
+            throw std::runtime_error{"Parent object " + std::to_string(parent) + " doesn't exist!"};
+        }
+
+        for(ObjectId ancestor{parent}; ancestor != NO_PARENT; ancestor = m_parents[ancestor])
+        {
+            if(ancestor == child)
+            {
+                throw std::runtime_error{"Parenting object " + std::to_string(child) + " to " +
+                                         std::to_string(parent) + " would create a cycle!"};
+            }
+        }
+
+        m_parents[child] = parent;
+        m_worldDirty[child] = 1;
+        m_anyDirty = true;
+        m_hierarchyChanged = true;
+    }
+
+    void Scene::buildUpdateOrder(void)
+    {
+        // Depth of every object, each chain is walked once thanks to the memo
+        constexpr std::uint32_t UNKNOWN{std::numeric_limits<std::uint32_t>::max()};
+        std::vector<std::uint32_t> depths(size(), UNKNOWN);
+        std::vector<ObjectId> chain;
+
+        for(ObjectId object{}; object < size(); ++object)
+        {
+            ObjectId current{object};
+            while(current != NO_PARENT && depths[current] == UNKNOWN)
+            {
+                chain.push_back(current);
+                current = m_parents[current];
+            }
+
+            std::uint32_t depth{current == NO_PARENT ? 0 : depths[current] + 1};
+            for(auto link{chain.rbegin()}; link != chain.rend(); ++link)
+            {
+                depths[*link] = depth++;
+            }
+            chain.clear();
+        }
+
+        // Stable, so siblings keep their memory order
+        std::stable_sort(m_updateOrder.begin(), m_updateOrder.end(),
+                         [&depths](ObjectId a, ObjectId b) { return depths[a] < depths[b]; });
+
+        m_levelOffsets.clear();
+        for(std::size_t i{}; i < m_updateOrder.size(); ++i)
+        {
+            if(i == 0 || depths[m_updateOrder[i]] != depths[m_updateOrder[i - 1]])
+            {
+                m_levelOffsets.push_back(i);
+            }
+        }
+        m_levelOffsets.push_back(m_updateOrder.size());
+
+        m_hierarchyChanged = false;
+    }
+
+    void Scene::setTranslation(ObjectId object, glm::vec3 translation)
+    {
+        m_translationX[object] = translation.x;
+        m_translationY[object] = translation.y;
+        m_translationZ[object] = translation.z;
+        markDirty(object);
+    }
+
+    void Scene::setRotation(ObjectId object, glm::vec3 rotation)
+    {
+        m_rotationX[object] = rotation.x;
+        m_rotationY[object] = rotation.y;
+        m_rotationZ[object] = rotation.z;
+        markDirty(object);
+    }
+
+    void Scene::setScale(ObjectId object, glm::vec3 scale)
+    {
+        m_scaleX[object] = scale.x;
+        m_scaleY[object] = scale.y;
+        m_scaleZ[object] = scale.z;
+        markDirty(object);
+    }
+
+    glm::vec3 Scene::getTranslation(ObjectId object) const
+    {
+        return {m_translationX[object], m_translationY[object], m_translationZ[object]};
+    }
+
+    glm::vec3 Scene::getRotation(ObjectId object) const
+    {
+        return {m_rotationX[object], m_rotationY[object], m_rotationZ[object]};
+    }
+
+    glm::vec3 Scene::getScale(ObjectId object) const { return {m_scaleX[object], m_scaleY[object], m_scaleZ[object]}; }
+
+    void Scene::updateLocalMatricesBatch(std::size_t& first, std::size_t end)
+    {
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+        const std::array<const float*, 9> components{m_translationX.data(), m_translationY.data(),
+                                                     m_translationZ.data(), m_rotationX.data(),
+                                                     m_rotationY.data(),    m_rotationZ.data(),
+                                                     m_scaleX.data(),       m_scaleY.data(),
+                                                     m_scaleZ.data()};
+
+        // Clean lanes are recomputed along with dirty ones, that's cheaper than gathering them
+        const auto anyDirty{[this](std::size_t begin, std::size_t count)
+                            {
+                                return std::any_of(m_localDirty.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                   m_localDirty.begin() + static_cast<std::ptrdiff_t>(begin + count),
+                                                   [](std::uint8_t dirty) { return dirty != 0; });
+                            }};
+#if defined(__AVX__)
+        for(; first + 8 <= end; first += 8)
+        {
+            if(anyDirty(first, 8))
+            {
+                computeLocalMatrices<Avx>(components.data(), first, m_localMatrices.data());
+            }
+        }
+#endif
+        for(; first + 4 <= end; first += 4)
+        {
+            if(anyDirty(first, 4))
+            {
+                computeLocalMatrices<Sse>(components.data(), first, m_localMatrices.data());
+            }
+        }
+#else
+        static_cast<void>(first);
+        static_cast<void>(end);
+#endif
+    }
+
+    void Scene::updateLocalMatrices(std::size_t begin, std::size_t end)
+    {
+        updateLocalMatricesBatch(begin, end);
+
+        // Whatever doesn't fill a whole register, or everything on other architectures
+        for(; begin < end; ++begin)
+        {
+            if(m_localDirty[begin])
+            {
+                TransformComponent transform{};
+                transform.translation = getTranslation(static_cast<ObjectId>(begin));
+                transform.rotation = getRotation(static_cast<ObjectId>(begin));
+                transform.scale = getScale(static_cast<ObjectId>(begin));
+
+                m_localMatrices[begin] = transform.mat4();
+            }
+        }
+    }
+
+    void Scene::updateWorldMatrices(JobSystem& jobSystem)
+    {
+        if(!m_anyDirty)
+        {
+            return;
+        }
+
+        // Ranges start on a multiple of 8 so no SIMD batch is split between two jobs
+        constexpr std::size_t BLOCK{8};
+        jobSystem.parallelFor((size() + BLOCK - 1) / BLOCK, MIN_OBJECTS_PER_JOB / BLOCK,
+                              [this](std::size_t begin, std::size_t end)
+                              { updateLocalMatrices(begin * BLOCK, std::min(end * BLOCK, size())); });
+
+        if(m_hierarchyChanged)
+        {
+            buildUpdateOrder();
+        }
+
+        // Parents are final before their children are visited, a dirty parent drags its whole subtree along.
+        // Objects of one depth only read the level above, so each level is spread over the workers
+        for(std::size_t level{}; level + 1 < m_levelOffsets.size(); ++level)
+        {
+            const std::size_t levelBegin{m_levelOffsets[level]};
+
+            jobSystem.parallelFor(
+                  m_levelOffsets[level + 1] - levelBegin, MIN_OBJECTS_PER_JOB,
+                  [this, levelBegin](std::size_t begin, std::size_t end)
+                  {
+                      for(std::size_t i{levelBegin + begin}; i < levelBegin + end; ++i)
+                      {
+                          const ObjectId object{m_updateOrder[i]};
+                          const ObjectId parent{m_parents[object]};
+                          const bool parentMoved{parent != NO_PARENT && m_worldDirty[parent]};
+
+                          if(m_localDirty[object] || m_worldDirty[object] || parentMoved)
+                          {
+                              m_worldMatrices[object] = parent == NO_PARENT
+                                                              ? m_localMatrices[object]
+                                                              : m_worldMatrices[parent] * m_localMatrices[object];
+                              m_worldDirty[object] = 1;
+                          }
+                      }
+                  });
+        }
+
+        std::fill(m_localDirty.begin(), m_localDirty.end(), std::uint8_t{});
+        std::fill(m_worldDirty.begin(), m_worldDirty.end(), std::uint8_t{});
+        m_anyDirty = false;
+        ++m_version;
+    }
+}
@@ -0,0 +1,204 @@
+#include "Settings.h"
+
+// std
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace VE
+{
+    // Returns the value that follows an option, e.g. "--frames 100"
+    static std::string_view optionValue(std::span<char*> args, std::size_t& argIndex)
+    {
+        if(argIndex + 1 >= args.size())
+        {
+            throw std::runtime_error{"Missing value for option " + std::string{args[argIndex]} + "!"};
+        }
+
+        return args[++argIndex];
+    }
+
+    // Rejects anything above max, so the caller's narrowing cast can't wrap
+    static std::uint64_t toUnsigned(std::string_view option, std::string_view value,
+                                    std::uint64_t max = std::numeric_limits<std::uint64_t>::max())
+    {
+        try
+        {
+            std::size_t parsed{};
+            const std::string text{value};
+
+            // stoull happily negates "-1" into the largest value
+            if(text.find('-') != std::string::npos)
+            {
+                throw std::out_of_range{text};
+            }
+
+            const auto number{std::stoull(text, &parsed)};
+
+            if(parsed != text.size())
+            {
+                throw std::invalid_argument{text};
+            }
+
+            if(number > max)
+            {
+                throw std::out_of_range{text};
+            }
+            return number;
+        }
+        catch(const std::logic_error&)
+        {
+            throw std::runtime_error{"Invalid value \"" + std::string{value} + "\" for option " + std::string{option} +
+                                     "!"};
+        }
+    }
+
+    Settings Settings::fromCommandLine(int argc, char** argv)
+    {
+        Settings settings{};
+        std::span<char*> args{argv, static_cast<std::size_t>(argc)};
+
+        for(std::size_t argIndex{1}; argIndex < args.size(); ++argIndex)
+        {
+            const std::string_view option{args[argIndex]};
+
+            if(option == "--headless")
+            {
+                settings.headless = true;
+            }
+            else if(option == "--width")
+            {
+                settings.width = static_cast<std::int32_t>(
+                      toUnsigned(option, optionValue(args, argIndex), std::numeric_limits<std::int32_t>::max()));
+            }
+            else if(option == "--height")
+            {
+                settings.height = static_cast<std::int32_t>(
+                      toUnsigned(option, optionValue(args, argIndex), std::numeric_limits<std::int32_t>::max()));
+            }
+            else if(option == "--frames")
+            {
+                settings.maxFrames = toUnsigned(option, optionValue(args, argIndex));
+            }
+            else if(option == "--benchmark")
+            {
+                settings.benchmark = true;
+            }
+            else if(option == "--warmup")
+            {
+                settings.warmupFrames = toUnsigned(option, optionValue(args, argIndex));
+            }
+            else if(option == "--report")
+            {
+                settings.reportPath = optionValue(args, argIndex);
+            }
+            else if(option == "--cubes")
+            {
+                settings.cubeCount = toUnsigned(option, optionValue(args, argIndex));
+            }
+            else if(option == "--threads")
+            {
+                settings.workerThreads = static_cast<std::uint32_t>(
+                      toUnsigned(option, optionValue(args, argIndex), std::numeric_limits<std::uint32_t>::max()));
+            }
+            else if(option == "--frames-in-flight")
+            {
+                settings.framesInFlight = static_cast<std::uint32_t>(
+                      toUnsigned(option, optionValue(args, argIndex), std::numeric_limits<std::uint32_t>::max()));
+            }
+            else if(option == "--pin-threads")
+            {
+                settings.pinThreads = true;
+            }
+            else if(option == "--gpu-culling")
+            {
+                settings.gpuCulling = true;
+            }
+            else if(option == "--hot-reload")
+            {
+                settings.hotReload = true;
+            }
+            else if(option == "--model")
+            {
+                settings.modelPaths.emplace_back(optionValue(args, argIndex));
+            }
+            else if(option == "--fps-limit")
+            {
+                settings.fpsLimit = static_cast<double>(toUnsigned(option, optionValue(args, argIndex)));
+            }
+            else if(option == "--present-mode")
+            {
+                const std::string_view mode{optionValue(args, argIndex)};
+                if(mode == "fifo")
+                {
+                    settings.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+                }
+                else if(mode == "fifo-relaxed")
+                {
+                    settings.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+                }
+                else if(mode == "mailbox")
+                {
+                    settings.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+                }
+                else if(mode == "immediate")
+                {
+                    settings.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+                }
+                else
+                {
+                    throw std::runtime_error{"Unknown present mode " + std::string{mode} + "!"};
+                }
+            }
+            else if(option == "--report-format")
+            {
+                const std::string_view format{optionValue(args, argIndex)};
+                if(format == "json")
+                {
+                    settings.reportFormat = ReportFormat::Json;
+                }
+                else if(format == "csv")
+                {
+                    settings.reportFormat = ReportFormat::Csv;
+                }
+                else
+                {
+                    throw std::runtime_error{"Unknown report format " + std::string{format} + "!"};
+                }
+            }
+            else
+            {
+                throw std::runtime_error{"Unknown option " + std::string{option} + "!"};
+            }
+        }
+
+        if(settings.width <= 0 || settings.height <= 0)
+        {
+            throw std::runtime_error{"Width and height must be greater than zero!"};
+        }
+
+        if(settings.benchmark)
+        {
+            // The first frame pays for pipeline creation and the first submit, it is never a sample
+            if(settings.warmupFrames == 0)
+            {
+                throw std::runtime_error{"Benchmark mode needs at least one warm-up frame!"};
+            }
+
+            if(settings.maxFrames == 0)
+            {
+                settings.maxFrames = 1000;
+            }
+
+            if(settings.reportPath.empty())
+            {
+                settings.reportPath = settings.reportFormat == ReportFormat::Csv ? "benchmark.csv" : "benchmark.json";
+            }
+        }
+
+        return settings;
+    }
+}
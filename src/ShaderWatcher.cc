@@ -0,0 +1,219 @@
+#include "ShaderWatcher.h"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+// File change notifications
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Set by the build to the glslc it compiles the shaders with
+#ifndef VE_GLSLC_EXECUTABLE
+#define VE_GLSLC_EXECUTABLE "glslc"
+#endif
+
+// Set by the build to the absolute shader directory of the source tree
+#ifndef VE_SHADER_DIR
+#define VE_SHADER_DIR "shaders"
+#endif
+
+namespace VE
+{
+    // How long the watcher thread sleeps in poll(), bounds how long stopping it takes
+    static constexpr int POLL_TIMEOUT_MS{100};
+
+    // Editors often truncate and write, or write a temporary and rename, so changes are gathered this long
+    static constexpr int SETTLE_TIME_MS{50};
+
+    static bool isShaderSource(const std::filesystem::path& path)
+    {
+        const std::string extension{path.extension().string()};
+        return extension == ".vert" || extension == ".frag" || extension == ".comp";
+    }
+
+    // Constructor
+    ShaderWatcher::ShaderWatcher(Device& device)
+        : m_device{device},
+          m_directory{VE_SHADER_DIR},
+          m_inotify{-1}
+    {
+#if defined(__linux__)
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(m_inotify < 0)
+        {
+            throw std::runtime_error{"Failed to create an inotify instance!"};
+        }
+
+        // Close after write catches in-place saves, moved to catches editors that save by renaming
+        if(inotify_add_watch(m_inotify, m_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            close(m_inotify);
+            throw std::runtime_error{"Failed to watch " + m_directory + "!"};
+        }
+
+        m_thread = std::jthread{[this](std::stop_token stopToken) { watchLoop(std::move(stopToken)); }};
+#else
+        std::cerr << "Shader hot reload needs inotify, shaders won't be reloaded" << std::endl;
+#endif
+    }
+
+    // Destructor
+    ShaderWatcher::~ShaderWatcher(void)
+    {
+        if(m_thread.joinable())
+        {
+            m_thread.request_stop();
+            m_thread.join();
+        }
+
+#if defined(__linux__)
+        if(m_inotify >= 0)
+        {
+            close(m_inotify);
+        }
+#endif
+    }
+
+    void ShaderWatcher::watch(const std::vector<std::string>& sources, Rebuild rebuild)
+    {
+        std::vector<std::string> paths;
+        paths.reserve(sources.size());
+        for(const auto& source : sources)
+        {
+            paths.push_back((std::filesystem::path{m_directory} / source).generic_string());
+        }
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_watches.push_back({std::move(paths), std::move(rebuild)});
+    }
+
+    std::string ShaderWatcher::spirvPath(const std::string& source)
+    {
+        return (std::filesystem::path{VE_SHADER_DIR} / (source + ".spv")).generic_string();
+    }
+
+    void ShaderWatcher::applyReloads(std::uint64_t lastSubmittedFrame)
+    {
+        const std::uint64_t completedFrame{m_device.getCompletedFrame()};
+        std::erase_if(m_retired, [&](const Retired& retired) { return retired.frameNumber <= completedFrame; });
+
+        std::vector<Swap> swaps;
+        {
+            std::unique_lock<std::mutex> lock{m_mutex, std::try_to_lock};
+            if(!lock.owns_lock())
+            {
+                return;
+            }
+            swaps.swap(m_pendingSwaps);
+        }
+
+        for(auto& swap : swaps)
+        {
+            m_retired.push_back({lastSubmittedFrame, swap()});
+        }
+    }
+
+    std::set<std::string> ShaderWatcher::readChanges(void)
+    {
+        std::set<std::string> changes;
+
+#if defined(__linux__)
+        alignas(inotify_event) std::array<char, 4096> buffer{};
+
+        pollfd pollInfo{m_inotify, POLLIN, 0};
+        int timeout{POLL_TIMEOUT_MS};
+
+        // Keeps draining until the directory has been quiet for SETTLE_TIME_MS
+        while(poll(&pollInfo, 1, timeout) > 0)
+        {
+            ssize_t length{};
+            while((length = read(m_inotify, buffer.data(), buffer.size())) > 0)
+            {
+                for(ssize_t offset{}; offset < length;)
+                {
+                    const auto* event{reinterpret_cast<const inotify_event*>(buffer.data() + offset)};
+                    if(event->len > 0 && isShaderSource(event->name))
+                    {
+                        changes.emplace(event->name);
+                    }
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                }
+            }
+            timeout = SETTLE_TIME_MS;
+        }
+#endif
+
+        return changes;
+    }
+
+    bool ShaderWatcher::compile(const std::string& source)
+    {
+        // Same command line as the build
+        const std::string command{std::string{"\""} + VE_GLSLC_EXECUTABLE + "\" -O \"" + source + "\" -o \"" + source +
+                                  ".spv\""};
+
+        // glslc prints the errors itself
+        return std::system(command.c_str()) == 0;
+    }
+
+    void ShaderWatcher::watchLoop(std::stop_token stopToken)
+    {
+        while(!stopToken.stop_requested())
+        {
+            const std::set<std::string> changes{readChanges()};
+            if(changes.empty())
+            {
+                continue;
+            }
+
+            std::set<std::string> compiled;
+            for(const auto& change : changes)
+            {
+                const std::string source{(std::filesystem::path{m_directory} / change).generic_string()};
+                if(compile(source))
+                {
+                    compiled.insert(source);
+                    std::cout << "Recompiled " << source << std::endl;
+                }
+            }
+
+            // Copied so the rebuilds run unlocked, they can take a while
+            std::vector<Watch> watches;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                watches = m_watches;
+            }
+
+            for(const auto& watch : watches)
+            {
+                const bool affected{std::any_of(watch.sources.begin(), watch.sources.end(),
+                                                [&](const std::string& source) { return compiled.contains(source); })};
+                if(!affected)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    Swap swap{watch.rebuild()};
+
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    m_pendingSwaps.push_back(std::move(swap));
+                }
+                catch(const std::exception& exception)
+                {
+                    std::cerr << "Keeping the old pipeline: " << exception.what() << std::endl;
+                }
+            }
+        }
+    }
+}
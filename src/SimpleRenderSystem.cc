@@ -1,5 +1,9 @@
 #include "SimpleRenderSystem.h"
 
+// Embedded SPIR-V
+#include "shaders/simple.frag.h"
+#include "shaders/simple.vert.h"
+
 // glm
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -7,46 +11,65 @@
 #include <glm/gtc/constants.hpp>
 
 // std
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 namespace VE
 {
-    struct SimplePushConstantData
+    // Vertex binding 1, advanced once per instance
+    struct InstanceData
     {
         glm::mat4 transform{1.0F};
-        alignas(16) glm::vec3 color;
+        glm::vec4 color{1.0F};
     };
 
     // Constructor
-    SimpleRenderSystem::SimpleRenderSystem(Device& device, VkRenderPass renderPass)
-        : m_device{device}, m_pipelineLayout{}
+    SimpleRenderSystem::SimpleRenderSystem(Device& device,
+                                           JobSystem& jobSystem,
+                                           PipelineRegistry& pipelineRegistry,
+                                           VkRenderPass renderPass,
+                                           VkDescriptorSetLayout globalSetLayout)
+        : m_device{device},
+          m_jobSystem{jobSystem},
+          m_pipelineRegistry{pipelineRegistry},
+          m_pipelineLayout{},
+          m_renderPass{renderPass}
     {
-        createPipelineLayout();
-        createPipeline(renderPass);
+        createPipelineLayout(globalSetLayout);
+        m_pipeline = createPipeline(Shaders::SIMPLE_VERT, Shaders::SIMPLE_FRAG);
     }
 
     // Destructor
     SimpleRenderSystem::~SimpleRenderSystem(void)
     {
+        for(auto& instanceBuffer : m_instanceBuffers)
+        {
+            if(instanceBuffer.buffer)
+            {
+                m_device.destroyBuffer(instanceBuffer.buffer, instanceBuffer.allocation);
+            }
+        }
+
         vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
     }
 
-    void SimpleRenderSystem::createPipelineLayout(void)
+    void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout)
     {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(SimplePushConstantData);
-
+        // Per-object data comes in through the instance buffer, the camera through the global set,
+        // so there's nothing left to push
         VkPipelineLayoutCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        createInfo.setLayoutCount = 0;
-        createInfo.pSetLayouts = nullptr;
-        createInfo.pushConstantRangeCount = 1;
-        createInfo.pPushConstantRanges = &pushConstantRange;
+        createInfo.setLayoutCount = 1;
+        createInfo.pSetLayouts = &globalSetLayout;
+        createInfo.pushConstantRangeCount = 0;
+        createInfo.pPushConstantRanges = nullptr;
 
         if(vkCreatePipelineLayout(m_device.device(), &createInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
         {
@@ -54,7 +77,8 @@ namespace VE
         }
     }
 
-    void SimpleRenderSystem::createPipeline(VkRenderPass renderPass)
+    std::shared_ptr<Pipeline> SimpleRenderSystem::createPipeline(std::span<const std::uint32_t> vertCode,
+                                                                 std::span<const std::uint32_t> fragCode) const
     {
         if(m_pipelineLayout == nullptr)
         {
@@ -64,34 +88,225 @@ namespace VE
         PipelineConfigInfo pipelineConfig{};
         Pipeline::defaultPipelineConfig(pipelineConfig);
 
-        pipelineConfig.renderPass = renderPass;
+        pipelineConfig.renderPass = m_renderPass;
         pipelineConfig.pipelineLayout = m_pipelineLayout;
 
-        m_pipeline = std::make_unique<Pipeline>(m_device, "shaders/simple.vert.spv", "shaders/simple.frag.spv",
-                                                pipelineConfig);
+        VkVertexInputBindingDescription instanceBinding{};
+        instanceBinding.binding = 1;
+        instanceBinding.stride = sizeof(InstanceData);
+        instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        pipelineConfig.bindingDescriptions.push_back(instanceBinding);
+
+        // A mat4 takes one location per column
+        for(std::uint32_t column{}; column < 4; ++column)
+        {
+            pipelineConfig.attributeDescriptions.push_back(
+                  {2 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT,
+                   static_cast<std::uint32_t>(offsetof(InstanceData, transform) + sizeof(glm::vec4) * column)});
+        }
+        pipelineConfig.attributeDescriptions.push_back(
+              {6, 1, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<std::uint32_t>(offsetof(InstanceData, color))});
+
+        return m_pipelineRegistry.getPipeline(vertCode, fragCode, pipelineConfig);
+    }
+
+    void SimpleRenderSystem::watchShaders(ShaderWatcher& watcher)
+    {
+        // Reloads use what the watcher just compiled, not the SPIR-V embedded at build time
+        const auto create{[this]
+                          {
+                              return createPipeline(Pipeline::readSpirv(ShaderWatcher::spirvPath("simple.vert")),
+                                                    Pipeline::readSpirv(ShaderWatcher::spirvPath("simple.frag")));
+                          }};
+
+        watcher.watch({"simple.vert", "simple.frag"}, ShaderWatcher::replace(m_pipeline, create));
+    }
+
+    SimpleRenderSystem::InstanceBuffer& SimpleRenderSystem::getInstanceBuffer(std::uint32_t frameIndex,
+                                                                            std::size_t instanceCount)
+    {
+        InstanceBuffer& instanceBuffer{m_instanceBuffers[frameIndex]};
+        if(instanceBuffer.capacity >= instanceCount)
+        {
+            return instanceBuffer;
+        }
+
+        if(instanceBuffer.buffer)
+        {
+            m_device.destroyBuffer(instanceBuffer.buffer, instanceBuffer.allocation);
+        }
+
+        // Double so a slowly growing scene doesn't reallocate every frame
+        instanceBuffer.capacity = std::max({instanceCount, instanceBuffer.capacity * 2, std::size_t{1024}});
+
+        // Written every frame and read once, host visible memory is good enough
+        m_device.createBuffer(sizeof(InstanceData) * instanceBuffer.capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              instanceBuffer.buffer, instanceBuffer.allocation);
+
+        return instanceBuffer;
     }
 
-    void SimpleRenderSystem::renderGameObjects(VkCommandBuffer commandBuffer, std::vector<GameObject>& gameObjects,
-                                               const Camera& camera)
+    void SimpleRenderSystem::renderScene(FrameInfo& frameInfo, const Scene& scene)
     {
+        std::uint32_t scope{GpuProfiler::INVALID_SCOPE};
+
+        const glm::mat4 projectionView{frameInfo.camera.getProjection() * frameInfo.camera.getView()};
+
+        const std::span<Model* const> models{scene.getModels()};
+        const std::span<const glm::mat4> worldMatrices{scene.getWorldMatrices()};
+
+        std::pmr::memory_resource* arena{&frameInfo.frameArena};
+
+        const std::size_t objectCount{scene.size()};
+        m_spheres.resize(objectCount);
+        m_culler.setViewProjection(projectionView);
+
+        // A few ranges per worker, concatenated in order afterwards so the result doesn't depend on scheduling
+        const std::size_t rangeCount{std::min<std::size_t>(
+              std::size_t{m_jobSystem.getThreadCount()} * 4,
+              (objectCount + MIN_OBJECTS_PER_CULL_RANGE - 1) / MIN_OBJECTS_PER_CULL_RANGE)};
+
+        // The inner vectors pick up the arena from the outer one
+        std::pmr::vector<std::pmr::vector<DrawItem>> rangeDraws(rangeCount, arena);
+
+        m_jobSystem.parallelFor(
+              rangeCount, 1,
+              [&](std::size_t beginRange, std::size_t endRange)
+              {
+                  for(std::size_t range{beginRange}; range < endRange; ++range)
+                  {
+                      const std::size_t first{objectCount * range / rangeCount};
+                      const std::size_t last{objectCount * (range + 1) / rangeCount};
+
+                      for(std::size_t object{first}; object < last; ++object)
+                      {
+                          if(!models[object])
+                          {
+                              // Fails every plane test
+                              m_spheres.set(object, {glm::vec3{0.0F}, -std::numeric_limits<float>::infinity()});
+                              continue;
+                          }
+
+                          const BoundingSphere& bounds{models[object]->getBoundingSphere()};
+                          const glm::mat4& world{worldMatrices[object]};
+
+                          // Parents scale too, so the largest axis comes from the world matrix itself
+                          const float maxScaleSquared{
+                                std::max({glm::dot(glm::vec3{world[0]}, glm::vec3{world[0]}),
+                                          glm::dot(glm::vec3{world[1]}, glm::vec3{world[1]}),
+                                          glm::dot(glm::vec3{world[2]}, glm::vec3{world[2]})})};
+
+                          m_spheres.set(object, {glm::vec3{world * glm::vec4{bounds.center, 1.0F}},
+                                                 bounds.radius * std::sqrt(maxScaleSquared)});
+                      }
+
+                      // Sized for the worst case up front, a grown arena vector leaves its old buffer behind
+                      std::pmr::vector<std::uint32_t> visible(last - first, arena);
+                      visible.resize(m_culler.cull(m_spheres, first, last, visible));
+
+                      std::pmr::vector<DrawItem>& draws{rangeDraws[range]};
+                      draws.reserve(visible.size());
+                      for(std::uint32_t object : visible)
+                      {
+                          draws.emplace_back(models[object], object);
+                      }
+                  }
+              });
+
+        std::size_t instanceCount{};
+        for(const auto& draws : rangeDraws)
+        {
+            instanceCount += draws.size();
+        }
+
+        // Group by model, every run of equal models becomes one instanced draw
+        std::pmr::vector<DrawItem> drawOrder{arena};
+        drawOrder.reserve(instanceCount);
+        for(const auto& draws : rangeDraws)
+        {
+            drawOrder.insert(drawOrder.end(), draws.begin(), draws.end());
+        }
+
+        std::sort(drawOrder.begin(), drawOrder.end());
+
+        const std::uint32_t taskCount{static_cast<std::uint32_t>(
+              std::min<std::size_t>(frameInfo.commandRecorder.getThreadCount(),
+                                    (instanceCount + MIN_INSTANCES_PER_TASK - 1) / MIN_INSTANCES_PER_TASK))};
+
+        const InstanceBuffer* instanceBuffer{
+              instanceCount ? &getInstanceBuffer(frameInfo.frameIndex, instanceCount) : nullptr};
+
+        // The primary may only execute secondaries inside the render pass, so even the timestamps get their own
+        std::pmr::vector<VkCommandBuffer> secondaries{arena};
+        secondaries.reserve(taskCount + 2);
+        secondaries.push_back(frameInfo.commandRecorder.recordInline(
+              [&](VkCommandBuffer commandBuffer)
+              { scope = frameInfo.gpuProfiler.beginScope(commandBuffer, "simpleRenderSystem"); }));
+
+        // Even slices of the sorted instances, a model run crossing a slice border is simply drawn in two parts
+        const std::span<const VkCommandBuffer> recorded{frameInfo.commandRecorder.record(
+              taskCount,
+              [&](VkCommandBuffer commandBuffer, std::uint32_t task)
+              {
+                  recordDraws(commandBuffer, *instanceBuffer, scene, frameInfo.globalDescriptorSet, drawOrder,
+                              instanceCount * task / taskCount, instanceCount * (task + 1) / taskCount);
+              })};
+        secondaries.insert(secondaries.end(), recorded.begin(), recorded.end());
+
+        secondaries.push_back(frameInfo.commandRecorder.recordInline(
+              [&](VkCommandBuffer commandBuffer) { frameInfo.gpuProfiler.endScope(commandBuffer, scope); }));
+
+        vkCmdExecuteCommands(frameInfo.commandBuffer, static_cast<std::uint32_t>(secondaries.size()),
+                             secondaries.data());
+    }
+
+    void SimpleRenderSystem::recordDraws(VkCommandBuffer commandBuffer,
+                                         const InstanceBuffer& instanceBuffer,
+                                         const Scene& scene,
+                                         VkDescriptorSet globalDescriptorSet,
+                                         std::span<const DrawItem> drawOrder,
+                                         std::size_t first,
+                                         std::size_t last) const
+    {
+        const std::span<const glm::mat4> worldMatrices{scene.getWorldMatrices()};
+        const std::span<const glm::vec3> colors{scene.getColors()};
+        auto* instances{static_cast<InstanceData*>(instanceBuffer.allocation.mappedData)};
+
+        // Every thread writes its own slice of the mapped buffer
+        for(std::size_t instance{first}; instance < last; ++instance)
+        {
+            const Scene::ObjectId object{drawOrder[instance].second};
+
+            InstanceData data{};
+            data.transform = worldMatrices[object];
+            data.color = glm::vec4{colors[object], 1.0F};
+            std::memcpy(instances + instance, &data, sizeof(data));
+        }
+
         m_pipeline->bind(commandBuffer);
 
-        auto projectionView{camera.getProjection() * camera.getView()};
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1,
+                                &globalDescriptorSet, 0, nullptr);
+
+        const VkDeviceSize offset{0};
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer.buffer, &offset);
 
         // Render
-        for(auto& obj : gameObjects)
+        while(first < last)
         {
+            Model* model{drawOrder[first].first};
 
-            SimplePushConstantData push{};
-            // push.color = obj.objColor;
-            push.transform = projectionView * obj.transform.mat4();
+            std::size_t runEnd{first + 1};
+            while(runEnd < last && drawOrder[runEnd].first == model)
+            {
+                ++runEnd;
+            }
 
-            vkCmdPushConstants(commandBuffer, m_pipelineLayout,
-                               VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0,
-                               sizeof(SimplePushConstantData), &push);
+            model->bind(commandBuffer);
+            model->draw(commandBuffer, static_cast<std::uint32_t>(runEnd - first), static_cast<std::uint32_t>(first));
 
-            obj.model->bind(commandBuffer);
-            obj.model->draw(commandBuffer);
+            first = runEnd;
         }
     }
 }
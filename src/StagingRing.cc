@@ -0,0 +1,374 @@
+#include "StagingRing.h"
+#include "Device.h"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace VE
+{
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Constructor
+    StagingRing::StagingRing(Device& device, VkDeviceSize capacity)
+        : m_device{device},
+          m_buffer{},
+          m_allocation{},
+          m_capacity{capacity},
+          m_head{},
+          m_tail{},
+          m_transferFamily{device.transferFamily()},
+          m_graphicsFamily{device.findPhysicalQueueFamilies().graphicsFamily.value()},
+          m_commandPool{},
+          m_acquireCommandPool{},
+          m_recording{},
+          m_timeline{},
+          m_timelineValue{}
+    {
+        m_device.createBuffer(m_capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_buffer,
+                              m_allocation);
+        createCommandPools();
+        createTimeline();
+    }
+
+    // Destructor
+    StagingRing::~StagingRing(void)
+    {
+        waitIdle();
+
+        vkDestroySemaphore(m_device.device(), m_timeline, nullptr);
+
+        // Takes every command buffer allocated from it along
+        vkDestroyCommandPool(m_device.device(), m_commandPool, nullptr);
+        if(m_acquireCommandPool)
+        {
+            vkDestroyCommandPool(m_device.device(), m_acquireCommandPool, nullptr);
+        }
+        m_device.destroyBuffer(m_buffer, m_allocation);
+    }
+
+    void StagingRing::createCommandPools(void)
+    {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = m_transferFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        if(vkCreateCommandPool(m_device.device(), &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create staging command pool!"};
+        }
+
+        if(!hasOwnershipTransfer())
+        {
+            return;
+        }
+
+        poolInfo.queueFamilyIndex = m_graphicsFamily;
+        if(vkCreateCommandPool(m_device.device(), &poolInfo, nullptr, &m_acquireCommandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create staging acquire command pool!"};
+        }
+    }
+
+    void StagingRing::createTimeline(void)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+
+        if(vkCreateSemaphore(m_device.device(), &semaphoreInfo, nullptr, &m_timeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create staging timeline semaphore!"};
+        }
+    }
+
+    void StagingRing::reclaim(bool wait)
+    {
+        std::uint64_t completed{};
+        vkGetSemaphoreCounterValue(m_device.device(), m_timeline, &completed);
+
+        while(!m_inFlight.empty())
+        {
+            Submission& oldest{m_inFlight.front()};
+
+            // Only ever block on the oldest one, the rest is picked up if it's already done
+            if(oldest.timelineValue > completed)
+            {
+                if(!wait)
+                {
+                    break;
+                }
+
+                VkSemaphoreWaitInfo waitInfo{};
+                waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+                waitInfo.semaphoreCount = 1;
+                waitInfo.pSemaphores = &m_timeline;
+                waitInfo.pValues = &oldest.timelineValue;
+                vkWaitSemaphores(m_device.device(), &waitInfo, std::numeric_limits<std::uint64_t>::max());
+
+                completed = oldest.timelineValue;
+                wait = false;
+            }
+
+            m_tail = oldest.end;
+
+            vkResetCommandBuffer(oldest.commandBuffer, 0);
+            m_freeCommandBuffers.push_back(oldest.commandBuffer);
+
+            if(oldest.acquireCommandBuffer)
+            {
+                vkResetCommandBuffer(oldest.acquireCommandBuffer, 0);
+                m_freeAcquireCommandBuffers.push_back(oldest.acquireCommandBuffer);
+            }
+
+            m_inFlight.pop_front();
+        }
+    }
+
+    VkDeviceSize StagingRing::reserve(VkDeviceSize size)
+    {
+        for(;;)
+        {
+            reclaim(false);
+
+            // Nothing pending, start over at the beginning of the ring so there is no wrap padding
+            if(m_head == m_tail)
+            {
+                m_head = m_tail = alignUp(m_head, m_capacity);
+            }
+
+            // vkCmdCopyBuffer doesn't need it, but aligned copies are faster on every vendor
+            const VkDeviceSize head{alignUp(m_head, 16)};
+            const VkDeviceSize ringOffset{head % m_capacity};
+
+            // A copy never wraps, skip the tail end of the ring instead
+            const VkDeviceSize padding{ringOffset + size > m_capacity ? m_capacity - ringOffset : 0};
+
+            if(head + padding + size - m_tail <= m_capacity)
+            {
+                m_head = head + padding + size;
+                return (head + padding) % m_capacity;
+            }
+
+            // The ring is full: make sure what we recorded is on its way, then wait for the oldest batch
+            if(m_inFlight.empty())
+            {
+                flushLocked();
+            }
+            reclaim(true);
+        }
+    }
+
+    VkCommandBuffer StagingRing::allocateCommandBuffer(VkCommandPool commandPool,
+                                                       std::vector<VkCommandBuffer>& freeList)
+    {
+        if(freeList.empty())
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = commandPool;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer{};
+            if(vkAllocateCommandBuffers(m_device.device(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to allocate staging command buffer!"};
+            }
+            freeList.push_back(commandBuffer);
+        }
+
+        VkCommandBuffer commandBuffer{freeList.back()};
+        freeList.pop_back();
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to begin recording staging command buffer!"};
+        }
+
+        return commandBuffer;
+    }
+
+    VkCommandBuffer StagingRing::getRecordingCommandBuffer(void)
+    {
+        if(!m_recording)
+        {
+            m_recording = allocateCommandBuffer(m_commandPool, m_freeCommandBuffers);
+        }
+
+        return m_recording;
+    }
+
+    void StagingRing::flushLocked(void)
+    {
+        if(!m_recording)
+        {
+            return;
+        }
+
+        if(hasOwnershipTransfer())
+        {
+            // Release half, the copied ranges leave the transfer family
+            vkCmdPipelineBarrier(m_recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                 0, nullptr, static_cast<std::uint32_t>(m_ownershipBarriers.size()),
+                                 m_ownershipBarriers.data(), 0, nullptr);
+        }
+        else
+        {
+            // Make the copies visible to everything submitted after this batch on the same queue
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+            vkCmdPipelineBarrier(m_recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+                                 &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        if(vkEndCommandBuffer(m_recording) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to finish recording staging command buffer!"};
+        }
+
+        const std::uint64_t copiedValue{++m_timelineValue};
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &copiedValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_recording;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &m_timeline;
+
+        if(vkQueueSubmit(m_device.transferQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to submit staging command buffer!"};
+        }
+
+        Submission submission{m_recording, VK_NULL_HANDLE, copiedValue, m_head};
+        m_recording = VK_NULL_HANDLE;
+
+        if(hasOwnershipTransfer())
+        {
+            // Acquire half, waits for the copies on the GPU and lands in the graphics queue before the next frame
+            submission.acquireCommandBuffer = allocateCommandBuffer(m_acquireCommandPool, m_freeAcquireCommandBuffers);
+
+            for(auto& barrier : m_ownershipBarriers)
+            {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            }
+
+            vkCmdPipelineBarrier(submission.acquireCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+                                 static_cast<std::uint32_t>(m_ownershipBarriers.size()), m_ownershipBarriers.data(), 0,
+                                 nullptr);
+            m_ownershipBarriers.clear();
+
+            if(vkEndCommandBuffer(submission.acquireCommandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to finish recording staging acquire command buffer!"};
+            }
+
+            const std::uint64_t acquiredValue{++m_timelineValue};
+            const VkPipelineStageFlags waitStage{VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+
+            timelineInfo.waitSemaphoreValueCount = 1;
+            timelineInfo.pWaitSemaphoreValues = &copiedValue;
+            timelineInfo.pSignalSemaphoreValues = &acquiredValue;
+
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &m_timeline;
+            submitInfo.pWaitDstStageMask = &waitStage;
+            submitInfo.pCommandBuffers = &submission.acquireCommandBuffer;
+
+            if(vkQueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to submit staging acquire command buffer!"};
+            }
+
+            submission.timelineValue = acquiredValue;
+        }
+
+        m_inFlight.push_back(submission);
+    }
+
+    void StagingRing::upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        // Bigger uploads go through in pieces so the ring never has to hold all of them at once
+        const VkDeviceSize chunkSize{m_capacity / 2};
+
+        for(VkDeviceSize copied{}; copied < size;)
+        {
+            const VkDeviceSize chunk{std::min(size - copied, chunkSize)};
+            const VkDeviceSize ringOffset{reserve(chunk)};
+
+            std::memcpy(static_cast<char*>(m_allocation.mappedData) + ringOffset,
+                        static_cast<const char*>(data) + copied, static_cast<std::size_t>(chunk));
+
+            VkBufferCopy copyRegion{};
+            copyRegion.srcOffset = ringOffset;
+            copyRegion.dstOffset = dstOffset + copied;
+            copyRegion.size = chunk;
+            vkCmdCopyBuffer(getRecordingCommandBuffer(), m_buffer, dstBuffer, 1, &copyRegion);
+
+            // Exclusive buffers keep their contents across families only through a release/acquire pair
+            if(hasOwnershipTransfer())
+            {
+                VkBufferMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = 0;
+                barrier.srcQueueFamilyIndex = m_transferFamily;
+                barrier.dstQueueFamilyIndex = m_graphicsFamily;
+                barrier.buffer = dstBuffer;
+                barrier.offset = copyRegion.dstOffset;
+                barrier.size = chunk;
+                m_ownershipBarriers.push_back(barrier);
+            }
+
+            copied += chunk;
+        }
+    }
+
+    void StagingRing::flush(void)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        flushLocked();
+        reclaim(false);
+    }
+
+    void StagingRing::waitIdle(void)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        flushLocked();
+
+        while(!m_inFlight.empty())
+        {
+            reclaim(true);
+        }
+    }
+}
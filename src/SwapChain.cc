@@ -1,6 +1,7 @@
 #include "SwapChain.h"
 
 // std
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstdlib>
@@ -14,46 +15,46 @@
 namespace VE
 {
 
-    SwapChain::SwapChain(Device& device, VkExtent2D windowExtent)
+    SwapChain::SwapChain(Device& device,
+                         VkExtent2D windowExtent,
+                         std::uint32_t framesInFlight,
+                         VkPresentModeKHR presentMode)
         : m_swapChainImageFormat{},
+          m_swapChainDepthFormat{},
           m_swapChainExtent{},
           m_renderPass{},
+          m_nextOffscreenImage{},
           m_device{device},
           m_windowExtent{windowExtent},
           m_swapChain{},
-          m_currentFrame{}
+          m_preferredPresentMode{presentMode},
+          m_framesInFlight{framesInFlight},
+          m_currentFrame{},
+          m_lastFrameNumber{}
     {
         init();
     }
 
-    SwapChain::SwapChain(Device& device, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previousSwapChain)
-        : m_swapChainImageFormat{},
-          m_swapChainExtent{},
-          m_renderPass{},
-          m_device{device},
-          m_windowExtent{windowExtent},
-          m_swapChain{},
-          m_oldSwapChain{std::move(previousSwapChain)},
-          m_currentFrame{}
-    {
-        init();
-
-        // clean up the old swap chain
-        m_oldSwapChain = nullptr;
-    }
-
     void SwapChain::init(void)
     {
-        createSwapChain();
+        if(m_device.isHeadless())
+        {
+            createOffscreenImages();
+        }
+        else
+        {
+            createSwapChain(VK_NULL_HANDLE);
+        }
         createImageViews();
         createRenderPass();
-        createDepthResources();
         createFramebuffers();
         createSyncObjects();
     }
 
     SwapChain::~SwapChain(void)
     {
+        collectRetiredResources(true);
+
         for(auto& imageView : m_swapChainImageViews)
         {
             vkDestroyImageView(m_device.device(), imageView, nullptr);
@@ -66,11 +67,10 @@ namespace VE
             m_swapChain = nullptr;
         }
 
-        for(std::uint32_t imageIndex{}; imageIndex < m_depthImages.size(); ++imageIndex)
+        // Swap chain images belong to the VkSwapchainKHR, offscreen ones are ours
+        for(std::size_t imageIndex{}; imageIndex < m_offscreenImageAllocations.size(); ++imageIndex)
         {
-            vkDestroyImageView(m_device.device(), m_depthImageViews[imageIndex], nullptr);
-            vkDestroyImage(m_device.device(), m_depthImages[imageIndex], nullptr);
-            vkFreeMemory(m_device.device(), m_depthImageMemorys[imageIndex], nullptr);
+            m_device.destroyImage(m_swapChainImages[imageIndex], m_offscreenImageAllocations[imageIndex]);
         }
 
         for(auto& framebuffer : m_swapChainFramebuffers)
@@ -81,22 +81,146 @@ namespace VE
         vkDestroyRenderPass(m_device.device(), m_renderPass, nullptr);
 
         // cleanup synchronization objects
-        for(std::size_t semaIndex{}; semaIndex < MAX_FRAMES_IN_FLIGHT; ++semaIndex)
+        for(std::size_t semaIndex{}; semaIndex < m_framesInFlight; ++semaIndex)
         {
             vkDestroySemaphore(m_device.device(), m_renderFinishedSemaphores[semaIndex], nullptr);
             vkDestroySemaphore(m_device.device(), m_imageAvailableSemaphores[semaIndex], nullptr);
-            vkDestroyFence(m_device.device(), m_inFlightFences[semaIndex], nullptr);
         }
     }
 
+    void SwapChain::recreate(VkExtent2D windowExtent)
+    {
+        RetiredResources retired{};
+        retired.frameNumber = m_lastFrameNumber;
+        retired.imageViews = std::exchange(m_swapChainImageViews, {});
+        retired.framebuffers = std::exchange(m_swapChainFramebuffers, {});
+
+        const VkFormat previousImageFormat{m_swapChainImageFormat};
+        m_windowExtent = windowExtent;
+
+        if(m_device.isHeadless())
+        {
+            retired.offscreenImages = std::exchange(m_swapChainImages, {});
+            retired.offscreenImageAllocations = std::exchange(m_offscreenImageAllocations, {});
+            createOffscreenImages();
+        }
+        else
+        {
+            // Hands the old images' presentation over, it is only retired, not destroyed yet
+            retired.swapChain = std::exchange(m_swapChain, VK_NULL_HANDLE);
+            createSwapChain(retired.swapChain);
+        }
+
+        if(m_swapChainImageFormat != previousImageFormat)
+        {
+            m_retiredResources.push_back(std::move(retired));
+            throw std::runtime_error{"Swap chain image format has changed!"};
+        }
+
+        createImageViews();
+        createFramebuffers();
+
+        // The new images have never been rendered to
+        m_imageFrames.assign(imageCount(), 0);
+        m_nextOffscreenImage = 0;
+
+        m_retiredResources.push_back(std::move(retired));
+    }
+
+    void SwapChain::destroyRetiredResources(RetiredResources& retired)
+    {
+        for(auto& framebuffer : retired.framebuffers)
+        {
+            vkDestroyFramebuffer(m_device.device(), framebuffer, nullptr);
+        }
+
+        for(auto& imageView : retired.imageViews)
+        {
+            vkDestroyImageView(m_device.device(), imageView, nullptr);
+        }
+
+        for(std::size_t imageIndex{}; imageIndex < retired.offscreenImages.size(); ++imageIndex)
+        {
+            m_device.destroyImage(retired.offscreenImages[imageIndex], retired.offscreenImageAllocations[imageIndex]);
+        }
+
+        if(retired.swapChain != VK_NULL_HANDLE)
+        {
+            vkDestroySwapchainKHR(m_device.device(), retired.swapChain, nullptr);
+        }
+    }
+
+    void SwapChain::collectRetiredResources(bool waitAll)
+    {
+        if(m_retiredResources.empty())
+        {
+            return;
+        }
+
+        const std::uint64_t completedFrame{m_device.getCompletedFrame()};
+
+        // Retired in frame order, so everything done sits at the front
+        auto retired{m_retiredResources.begin()};
+        for(; retired != m_retiredResources.end() && (waitAll || retired->frameNumber <= completedFrame); ++retired)
+        {
+            if(retired->frameNumber > completedFrame)
+            {
+                m_device.waitForFrame(retired->frameNumber);
+            }
+            destroyRetiredResources(*retired);
+        }
+        m_retiredResources.erase(m_retiredResources.begin(), retired);
+    }
+
+    VkFramebuffer SwapChain::getFrameBuffer(std::uint32_t index, VkImageView depthView)
+    {
+        if(m_swapChainFramebuffers[index] != VK_NULL_HANDLE && m_framebufferDepthViews[index] == depthView)
+        {
+            return m_swapChainFramebuffers[index];
+        }
+
+        // The depth view changed, e.g. the render graph was resized. The old framebuffer may still be in flight
+        if(m_swapChainFramebuffers[index] != VK_NULL_HANDLE)
+        {
+            RetiredResources retired{};
+            retired.frameNumber = m_lastFrameNumber;
+            retired.framebuffers.push_back(m_swapChainFramebuffers[index]);
+            m_retiredResources.push_back(std::move(retired));
+        }
+
+        std::array<VkImageView, 2> attachments{m_swapChainImageViews[index], depthView};
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = m_renderPass;
+        framebufferInfo.attachmentCount = static_cast<std::uint32_t>(attachments.size());
+        framebufferInfo.pAttachments = attachments.data();
+        framebufferInfo.width = m_swapChainExtent.width;
+        framebufferInfo.height = m_swapChainExtent.height;
+        framebufferInfo.layers = 1;
+
+        if(vkCreateFramebuffer(m_device.device(), &framebufferInfo, nullptr, &m_swapChainFramebuffers[index]) !=
+           VK_SUCCESS)
+        {
+            m_swapChainFramebuffers[index] = VK_NULL_HANDLE;
+            throw std::runtime_error{"Failed to create framebuffer!"};
+        }
+        m_framebufferDepthViews[index] = depthView;
+
+        return m_swapChainFramebuffers[index];
+    }
+
     VkResult SwapChain::acquireNextImage(std::uint32_t* imageIndex)
     {
-        // Waiting for the command buffer to finished executing
-        vkWaitForFences(m_device.device(),
-                        1,
-                        &m_inFlightFences[m_currentFrame],
-                        VK_TRUE,
-                        std::numeric_limits<std::uint64_t>::max());
+        collectRetiredResources(false);
+
+        // Offscreen images are handed out round-robin, nothing to acquire from a presentation engine
+        if(m_device.isHeadless())
+        {
+            *imageIndex = m_nextOffscreenImage;
+            m_nextOffscreenImage = (m_nextOffscreenImage + 1) % imageCount();
+            return VK_SUCCESS;
+        }
 
         return vkAcquireNextImageKHR(m_device.device(),
                                      m_swapChain,
@@ -106,13 +230,17 @@ namespace VE
                                      imageIndex);
     }
 
-    VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer* commandBuffer, std::uint32_t* imageIndex)
+    VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer* commandBuffer,
+                                             std::uint32_t* imageIndex,
+                                             std::uint64_t frameNumber)
     {
-        if(m_imagesInFlight[*imageIndex] != VK_NULL_HANDLE)
+        // Frame numbers start at 1, so 0 means the image was never rendered to
+        if(m_imageFrames[*imageIndex] != 0)
         {
-            vkWaitForFences(m_device.device(), 1, &m_imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
+            m_device.waitForFrame(m_imageFrames[*imageIndex]);
         }
-        m_imagesInFlight[*imageIndex] = m_inFlightFences[m_currentFrame];
+        m_imageFrames[*imageIndex] = frameNumber;
+        m_lastFrameNumber = frameNumber;
 
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -126,22 +254,47 @@ namespace VE
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = commandBuffer;
 
-        std::array<VkSemaphore, 1> signalSemaphores{m_renderFinishedSemaphores[m_currentFrame]};
+        // The timeline goes first so the headless path can drop the binary semaphore off the end
+        std::array<VkSemaphore, 2> signalSemaphores{m_device.frameTimeline(),
+                                                    m_renderFinishedSemaphores[m_currentFrame]};
+        std::array<std::uint64_t, 2> signalValues{frameNumber, 0};  // binary semaphores ignore their value
         submitInfo.signalSemaphoreCount = static_cast<std::uint32_t>(signalSemaphores.size());
         submitInfo.pSignalSemaphores = signalSemaphores.data();
 
-        vkResetFences(m_device.device(), 1, &m_inFlightFences[m_currentFrame]);
-        if(vkQueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, m_inFlightFences[m_currentFrame]) != VK_SUCCESS)
+        // Nobody signals image available or waits on render finished when there is no presentation engine,
+        // the frame timeline alone guards the offscreen image
+        if(m_device.isHeadless())
+        {
+            submitInfo.waitSemaphoreCount = 0;
+            submitInfo.signalSemaphoreCount = 1;
+        }
+
+        std::array<std::uint64_t, 1> waitValues{0};
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+        timelineInfo.pSignalSemaphoreValues = signalValues.data();
+        submitInfo.pNext = &timelineInfo;
+
+        if(vkQueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
         {
             throw std::runtime_error{"Failed to submit draw command buffer!"};
         }
 
+        if(m_device.isHeadless())
+        {
+            m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+            return VK_SUCCESS;
+        }
+
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
         // Waiting for the command buffer to finished executing
-        presentInfo.waitSemaphoreCount = static_cast<std::uint32_t>(signalSemaphores.size());
-        presentInfo.pWaitSemaphores = signalSemaphores.data();
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &m_renderFinishedSemaphores[m_currentFrame];
 
         std::vector<VkSwapchainKHR> swapChains{m_swapChain};
         presentInfo.swapchainCount = static_cast<std::uint32_t>(swapChains.size());
@@ -149,12 +302,12 @@ namespace VE
 
         presentInfo.pImageIndices = imageIndex;
 
-        m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
 
         return vkQueuePresentKHR(m_device.presentQueue(), &presentInfo);
     }
 
-    void SwapChain::createSwapChain(void)
+    void SwapChain::createSwapChain(VkSwapchainKHR oldSwapChain)
     {
         SwapChainSupportDetails swapChainSupport{m_device.getSwapChainSupport()};
 
@@ -203,7 +356,7 @@ namespace VE
         createInfo.presentMode = presentMode;
         createInfo.clipped = VK_TRUE;
 
-        createInfo.oldSwapchain = (m_oldSwapChain == nullptr) ? VK_NULL_HANDLE : m_oldSwapChain->m_swapChain;
+        createInfo.oldSwapchain = oldSwapChain;
 
         if(vkCreateSwapchainKHR(m_device.device(), &createInfo, nullptr, &m_swapChain) != VK_SUCCESS)
         {
@@ -222,6 +375,46 @@ namespace VE
         m_swapChainExtent = extent;
     }
 
+    void SwapChain::createOffscreenImages(void)
+    {
+        m_swapChainImageFormat = m_device.findSupportedFormat(
+              {VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_R8G8B8A8_UNORM},
+              VK_IMAGE_TILING_OPTIMAL,
+              VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+        m_swapChainExtent = m_windowExtent;
+
+        // One more than frames in flight, so the CPU can start a frame while the others are still rendering
+        const std::uint32_t offscreenImageCount{m_framesInFlight + 1};
+        m_swapChainImages.resize(offscreenImageCount);
+        m_offscreenImageAllocations.resize(offscreenImageCount);
+
+        for(std::uint32_t imageIndex{}; imageIndex < offscreenImageCount; ++imageIndex)
+        {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width = m_swapChainExtent.width;
+            imageInfo.extent.height = m_swapChainExtent.height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = m_swapChainImageFormat;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            // Transfer source so batch renders can read the result back
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.flags = 0;
+
+            m_device.createImageWithInfo(imageInfo,
+                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                         m_swapChainImages[imageIndex],
+                                         m_offscreenImageAllocations[imageIndex]);
+        }
+    }
+
     void SwapChain::createImageViews(void)
     {
         m_swapChainImageViews.resize(m_swapChainImages.size());
@@ -249,14 +442,17 @@ namespace VE
 
     void SwapChain::createRenderPass(void)
     {
+        m_swapChainDepthFormat = findDepthFormat();
+
+        // The image belongs to the render graph, whose barrier has it in the attachment layout already
         VkAttachmentDescription depthAttachment{};
-        depthAttachment.format = findDepthFormat();
+        depthAttachment.format = m_swapChainDepthFormat;
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         VkAttachmentReference depthAttachmentRef{};
@@ -271,7 +467,8 @@ namespace VE
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colorAttachment.finalLayout =
+              m_device.isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentReference colorAttachmentRef{};
         colorAttachmentRef.attachment = 0;
@@ -314,102 +511,26 @@ namespace VE
 
     void SwapChain::createFramebuffers(void)
     {
-        m_swapChainFramebuffers.resize(imageCount());
-        for(std::size_t imgaeIndex{}; imgaeIndex < imageCount(); ++imgaeIndex)
-        {
-            std::array<VkImageView, 2> attachments{m_swapChainImageViews[imgaeIndex], m_depthImageViews[imgaeIndex]};
-
-            VkExtent2D swapChainExtent{getSwapChainExtent()};
-            VkFramebufferCreateInfo framebufferInfo{};
-            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferInfo.renderPass = m_renderPass;
-            framebufferInfo.attachmentCount = static_cast<std::uint32_t>(attachments.size());
-            framebufferInfo.pAttachments = attachments.data();
-            framebufferInfo.width = swapChainExtent.width;
-            framebufferInfo.height = swapChainExtent.height;
-            framebufferInfo.layers = 1;
-
-            if(vkCreateFramebuffer(
-                     m_device.device(), &framebufferInfo, nullptr, &m_swapChainFramebuffers[imgaeIndex]) != VK_SUCCESS)
-            {
-                throw std::runtime_error{"Failed to create framebuffer!"};
-            }
-        }
-    }
-
-    void SwapChain::createDepthResources(void)
-    {
-        VkFormat depthFormat{findDepthFormat()};
-        m_swapChainDepthFormat = depthFormat;
-
-        VkExtent2D swapChainExtent{getSwapChainExtent()};
-
-        m_depthImages.resize(imageCount());
-        m_depthImageMemorys.resize(imageCount());
-        m_depthImageViews.resize(imageCount());
-
-        for(std::uint32_t imageIndex{}; imageIndex < m_depthImages.size(); ++imageIndex)
-        {
-            VkImageCreateInfo imageInfo{};
-            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            imageInfo.imageType = VK_IMAGE_TYPE_2D;
-            imageInfo.extent.width = swapChainExtent.width;
-            imageInfo.extent.height = swapChainExtent.height;
-            imageInfo.extent.depth = 1;
-            imageInfo.mipLevels = 1;
-            imageInfo.arrayLayers = 1;
-            imageInfo.format = depthFormat;
-            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-            imageInfo.flags = 0;
-
-            m_device.createImageWithInfo(imageInfo,
-                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                         m_depthImages[imageIndex],
-                                         m_depthImageMemorys[imageIndex]);
-
-            VkImageViewCreateInfo viewInfo{};
-            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            viewInfo.image = m_depthImages[imageIndex];
-            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            viewInfo.format = depthFormat;
-            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            viewInfo.subresourceRange.baseMipLevel = 0;
-            viewInfo.subresourceRange.levelCount = 1;
-            viewInfo.subresourceRange.baseArrayLayer = 0;
-            viewInfo.subresourceRange.layerCount = 1;
-
-            if(vkCreateImageView(m_device.device(), &viewInfo, nullptr, &m_depthImageViews[imageIndex]) != VK_SUCCESS)
-            {
-                throw std::runtime_error{"Failed to create texture image view!"};
-            }
-        }
+        // The depth view isn't known yet, getFrameBuffer() creates them
+        m_swapChainFramebuffers.assign(imageCount(), VK_NULL_HANDLE);
+        m_framebufferDepthViews.assign(imageCount(), VK_NULL_HANDLE);
     }
 
     void SwapChain::createSyncObjects(void)
     {
-        m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        m_imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+        m_imageAvailableSemaphores.resize(m_framesInFlight);
+        m_renderFinishedSemaphores.resize(m_framesInFlight);
+        m_imageFrames.resize(imageCount(), 0);
 
         VkSemaphoreCreateInfo semaphoreInfo{};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-        for(std::size_t syncObjIndex{}; syncObjIndex < MAX_FRAMES_IN_FLIGHT; ++syncObjIndex)
+        for(std::size_t syncObjIndex{}; syncObjIndex < m_framesInFlight; ++syncObjIndex)
         {
             if(vkCreateSemaphore(
                      m_device.device(), &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[syncObjIndex]) ||
-               vkCreateSemaphore(
-                     m_device.device(), &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[syncObjIndex]) ||
-               vkCreateFence(m_device.device(), &fenceInfo, nullptr, &m_inFlightFences[syncObjIndex]) != VK_SUCCESS)
+               vkCreateSemaphore(m_device.device(), &semaphoreInfo, nullptr,
+                                 &m_renderFinishedSemaphores[syncObjIndex]) != VK_SUCCESS)
             {
                 throw std::runtime_error{"Failed to create synchronization objects!"};
             }
@@ -432,23 +553,21 @@ namespace VE
 
     VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
     {
-        /* for(const auto& availablePresentMode : availablePresentModes)
-        {
-            if(availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-            {
-                std::cout << "Present mode: Mailbox" << std::endl;
-                return availablePresentMode;
-            }
+        const bool supported{std::find(availablePresentModes.begin(), availablePresentModes.end(),
+                                       m_preferredPresentMode) != availablePresentModes.end()};
 
-            if(availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-            {
-                std::cout << "Present mode: Immediate" << std::endl;
-                return availablePresentMode;
-            }
-        } */
+        // FIFO is the only mode every surface has to support
+        const VkPresentModeKHR presentMode{supported ? m_preferredPresentMode : VK_PRESENT_MODE_FIFO_KHR};
+
+        switch(presentMode)
+        {
+            case VK_PRESENT_MODE_MAILBOX_KHR: std::cout << "Present mode: Mailbox" << std::endl; break;
+            case VK_PRESENT_MODE_IMMEDIATE_KHR: std::cout << "Present mode: Immediate" << std::endl; break;
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR: std::cout << "Present mode: Relaxed V-Sync" << std::endl; break;
+            default: std::cout << "Present mode: V-Sync" << std::endl; break;
+        }
 
-        std::cout << "Present mode: V-Sync" << std::endl;
-        return VK_PRESENT_MODE_FIFO_KHR;
+        return presentMode;
     }
 
     VkExtent2D SwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
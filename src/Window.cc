@@ -6,8 +6,8 @@
 namespace VE
 {
     // Constructor
-    Window::Window(std::int32_t width, std::int32_t height, const std::string& name)
-        : m_window{}, m_width{width}, m_height{height}, m_name{name}, m_framebufferResized{}
+    Window::Window(std::int32_t width, std::int32_t height, const std::string& name, bool headless)
+        : m_window{}, m_width{width}, m_height{height}, m_name{name}, m_framebufferResized{}, m_headless{headless}
     {
         init();
     }
@@ -15,13 +15,24 @@ namespace VE
     // Destructor
     Window::~Window(void)
     {
+        if(m_headless)
+        {
+            return;
+        }
+
         glfwDestroyWindow(m_window);
         glfwTerminate();
     }
 
     void Window::init(void)
     {
-         glfwInit();
+        // Render nodes and CI boxes have no display, so don't touch GLFW at all
+        if(m_headless)
+        {
+            return;
+        }
+
+        glfwInit();
 
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
         glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -46,20 +57,36 @@ namespace VE
         veWindow->m_height = height;
     }
 
-    bool Window::shouldClose(void) { return glfwWindowShouldClose(m_window); }
+    bool Window::shouldClose(void) { return !m_headless && glfwWindowShouldClose(m_window); }
 
-    void Window::pollEvents(void) { glfwPollEvents(); }
+    void Window::pollEvents(void)
+    {
+        if(!m_headless)
+        {
+            glfwPollEvents();
+        }
+    }
 
     void Window::createWindowSurface(VkInstance instance, VkSurfaceKHR* surface)
     {
+        if(m_headless)
+        {
+            throw std::runtime_error{"Can't create a surface for a headless window!"};
+        }
+
         if(glfwCreateWindowSurface(instance, m_window, nullptr, surface) != VK_SUCCESS)
         {
             throw std::runtime_error{"Failed to create window surface!"};
         }
     }
 
-    std::vector<const char*> Window::getInstanceExtensions(void)
+    std::vector<const char*> Window::getInstanceExtensions(void) const
     {
+        if(m_headless)
+        {
+            return {};
+        }
+
         std::uint32_t extensionCount{};
         const char** glfwExtensions{glfwGetRequiredInstanceExtensions(&extensionCount)};
 
@@ -70,6 +97,11 @@ namespace VE
 
     VkExtent2D Window::getExtent(void)
     {
+        if(m_headless)
+        {
+            return {static_cast<std::uint32_t>(m_width), static_cast<std::uint32_t>(m_height)};
+        }
+
         std::int32_t width{};
         std::int32_t height{};
         glfwGetFramebufferSize(m_window, &width, &height);
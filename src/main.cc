@@ -1,23 +1,23 @@
 #include "Application.h"
+#include "Settings.h"
 
 // std
 #include <cstdlib>
 #include <exception>
 #include <iostream>
 
-int main(void)
+int main(int argc, char** argv)
 {
-    VE::Application app;
-
     try
     {
+        VE::Application app{VE::Settings::fromCommandLine(argc, argv)};
         app.run();
     }
     catch(const std::exception& e)
     {
         std::cerr << e.what() << '\n';
-        return EXIT_SUCCESS;
+        return EXIT_FAILURE;
     }
 
-    return EXIT_FAILURE;
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,104 @@
+#include "Test.h"
+
+#include "FrameStatistics.h"
+
+// std
+#include <initializer_list>
+
+namespace VE
+{
+    static constexpr double EPSILON{1e-12};
+
+    static FrameStatistics statisticsOf(std::initializer_list<double> samples)
+    {
+        FrameStatistics statistics{};
+        for(double sample : samples)
+        {
+            statistics.record(sample);
+        }
+        return statistics;
+    }
+
+    VE_TEST(emptySummaryIsZero)
+    {
+        const FrameTimeSummary summary{FrameStatistics{}.summarize()};
+
+        VE_CHECK(summary.count == 0);
+        VE_CHECK(summary.min == 0.0);
+        VE_CHECK(summary.p50 == 0.0);
+        VE_CHECK(summary.p99 == 0.0);
+        VE_CHECK(summary.max == 0.0);
+        VE_CHECK(summary.variance == 0.0);
+    }
+
+    // Every percentile of one sample is that sample, the variance of one sample is 0 rather than 0/0
+    VE_TEST(singleSample)
+    {
+        const FrameTimeSummary summary{statisticsOf({16.6}).summarize()};
+
+        VE_CHECK(summary.count == 1);
+        VE_CHECK_NEAR(summary.min, 16.6, EPSILON);
+        VE_CHECK_NEAR(summary.p50, 16.6, EPSILON);
+        VE_CHECK_NEAR(summary.p95, 16.6, EPSILON);
+        VE_CHECK_NEAR(summary.p99, 16.6, EPSILON);
+        VE_CHECK_NEAR(summary.max, 16.6, EPSILON);
+        VE_CHECK(summary.variance == 0.0);
+    }
+
+    // Percentiles interpolate between the two closest ranks
+    VE_TEST(twoSamplesInterpolate)
+    {
+        const FrameTimeSummary summary{statisticsOf({3.0, 1.0}).summarize()};
+
+        VE_CHECK_NEAR(summary.min, 1.0, EPSILON);
+        VE_CHECK_NEAR(summary.p50, 2.0, EPSILON);
+        VE_CHECK_NEAR(summary.p95, 2.9, EPSILON);
+        VE_CHECK_NEAR(summary.p99, 2.98, EPSILON);
+        VE_CHECK_NEAR(summary.max, 3.0, EPSILON);
+    }
+
+    // With 101 samples 0..100 every percentile lands exactly on a rank
+    VE_TEST(percentilesOnExactRanks)
+    {
+        FrameStatistics statistics{};
+        for(int sample{100}; sample >= 0; --sample)
+        {
+            statistics.record(static_cast<double>(sample));
+        }
+
+        const FrameTimeSummary summary{statistics.summarize()};
+
+        VE_CHECK(summary.count == 101);
+        VE_CHECK_NEAR(summary.p50, 50.0, EPSILON);
+        VE_CHECK_NEAR(summary.p95, 95.0, EPSILON);
+        VE_CHECK_NEAR(summary.p99, 99.0, EPSILON);
+        VE_CHECK_NEAR(summary.mean, 50.0, EPSILON);
+    }
+
+    VE_TEST(identicalSamples)
+    {
+        const FrameTimeSummary summary{statisticsOf({8.0, 8.0, 8.0, 8.0}).summarize()};
+
+        VE_CHECK_NEAR(summary.p50, 8.0, EPSILON);
+        VE_CHECK_NEAR(summary.p99, 8.0, EPSILON);
+        VE_CHECK_NEAR(summary.mean, 8.0, EPSILON);
+        VE_CHECK(summary.variance == 0.0);
+    }
+
+    // Sample variance, divided by n - 1
+    VE_TEST(sampleVariance)
+    {
+        const FrameTimeSummary summary{statisticsOf({2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}).summarize()};
+
+        VE_CHECK_NEAR(summary.mean, 5.0, EPSILON);
+        VE_CHECK_NEAR(summary.variance, 32.0 / 7.0, EPSILON);
+    }
+
+    // A large offset wipes out the variance if it's computed from the sum of squares
+    VE_TEST(varianceWithLargeOffset)
+    {
+        const FrameTimeSummary summary{statisticsOf({1e9 + 4.0, 1e9 + 7.0, 1e9 + 13.0, 1e9 + 16.0}).summarize()};
+
+        VE_CHECK_NEAR(summary.variance, 30.0, 1e-6);
+    }
+}
@@ -0,0 +1,117 @@
+#include "Test.h"
+
+#include "JobSystem.h"
+
+// std
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace VE
+{
+    // Every index in [0, count) has to be visited exactly once
+    static void checkCoverage(JobSystem& jobSystem, std::size_t count, std::size_t minGrain)
+    {
+        std::vector<std::atomic<std::uint32_t>> visits(count);
+
+        jobSystem.parallelFor(count, minGrain,
+                              [&](std::size_t begin, std::size_t end)
+                              {
+                                  for(std::size_t i{begin}; i < end; ++i)
+                                  {
+                                      visits[i].fetch_add(1, std::memory_order_relaxed);
+                                  }
+                              });
+
+        for(const auto& visit : visits)
+        {
+            VE_CHECK(visit.load() == 1);
+        }
+    }
+
+    VE_TEST(parallelForCoversEveryIndex)
+    {
+        JobSystem jobSystem{4};
+
+        for(std::size_t count : std::array<std::size_t, 6>{0, 1, 7, 64, 1000, 100003})
+        {
+            for(std::size_t minGrain : std::array<std::size_t, 4>{0, 1, 16, 4096})
+            {
+                checkCoverage(jobSystem, count, minGrain);
+            }
+        }
+
+        // More ranges than MAX_RANGES would allow, they have to be merged rather than dropped
+        checkCoverage(jobSystem, JobSystem::MAX_RANGES * 10, 1);
+    }
+
+    VE_TEST(parallelForOnOneThread)
+    {
+        JobSystem jobSystem{1};
+        checkCoverage(jobSystem, 12345, 1);
+    }
+
+    // Waiting inside a job runs other jobs instead of blocking, nesting must not deadlock
+    VE_TEST(nestedParallelFor)
+    {
+        JobSystem jobSystem{4};
+
+        constexpr std::size_t OUTER{64};
+        constexpr std::size_t INNER{1000};
+        std::atomic<std::size_t> total{};
+
+        for(int frame{}; frame < 50; ++frame)
+        {
+            total = 0;
+            jobSystem.parallelFor(OUTER, 1,
+                                  [&](std::size_t begin, std::size_t end)
+                                  {
+                                      for(std::size_t outer{begin}; outer < end; ++outer)
+                                      {
+                                          jobSystem.parallelFor(INNER, 16,
+                                                                [&](std::size_t innerBegin, std::size_t innerEnd)
+                                                                { total += innerEnd - innerBegin; });
+                                      }
+                                  });
+
+            VE_CHECK(total.load() == OUTER * INNER);
+        }
+    }
+
+    // The caller's range throwing still waits for the others, their tasks live on its stack
+    VE_TEST(parallelForRethrows)
+    {
+        JobSystem jobSystem{4};
+        std::atomic<std::size_t> visited{};
+
+        VE_CHECK_THROWS(jobSystem.parallelFor(1000, 1,
+                                              [&](std::size_t begin, std::size_t end)
+                                              {
+                                                  visited += end - begin;
+                                                  if(begin == 0)
+                                                  {
+                                                      throw std::runtime_error{"range failed"};
+                                                  }
+                                              }));
+
+        VE_CHECK(visited.load() == 1000);
+    }
+
+    VE_TEST(runAndWait)
+    {
+        JobSystem jobSystem{3};
+        JobSystem::Counter counter{};
+        std::atomic<int> sum{};
+
+        for(int job{1}; job <= 100; ++job)
+        {
+            jobSystem.run([&sum, job] { sum += job; }, counter);
+        }
+        jobSystem.wait(counter);
+
+        VE_CHECK(sum.load() == 5050);
+    }
+}
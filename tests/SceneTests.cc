@@ -0,0 +1,188 @@
+#include "Test.h"
+
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "Scene.h"
+
+// glm
+#include <glm/gtc/constants.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace VE
+{
+    // The SIMD sin/cos are a few ulp off std::sin/std::cos, relative to the entry for the big translations
+    static constexpr float MATRIX_TOLERANCE{1e-5F};
+
+    static void checkMatrix(const glm::mat4& actual, const glm::mat4& expected)
+    {
+        for(glm::length_t column{}; column < 4; ++column)
+        {
+            for(glm::length_t row{}; row < 4; ++row)
+            {
+                VE_CHECK_NEAR(actual[column][row], expected[column][row],
+                              MATRIX_TOLERANCE * std::max(1.0F, std::abs(expected[column][row])));
+            }
+        }
+    }
+
+    static std::vector<TransformComponent> randomTransforms(std::size_t count, float maxAngle)
+    {
+        std::mt19937 generator{1234};
+        std::uniform_real_distribution<float> translation{-100.0F, 100.0F};
+        std::uniform_real_distribution<float> angle{-maxAngle, maxAngle};
+        std::uniform_real_distribution<float> scale{0.1F, 2.0F};
+
+        std::vector<TransformComponent> transforms(count);
+        for(auto& transform : transforms)
+        {
+            transform.translation = {translation(generator), translation(generator), translation(generator)};
+            transform.rotation = {angle(generator), angle(generator), angle(generator)};
+            transform.scale = {scale(generator), scale(generator), scale(generator)};
+        }
+        return transforms;
+    }
+
+    // Set through the setters, createObject() builds the first local matrix with TransformComponent::mat4()
+    static Scene::ObjectId addObject(Scene& scene, const TransformComponent& transform,
+                                     Scene::ObjectId parent = Scene::NO_PARENT)
+    {
+        const Scene::ObjectId object{scene.createObject(nullptr, {}, glm::vec3{1.0F}, parent)};
+        scene.setTranslation(object, transform.translation);
+        scene.setRotation(object, transform.rotation);
+        scene.setScale(object, transform.scale);
+        return object;
+    }
+
+    // 37 objects cover the AVX and SSE batches as well as the scalar tail
+    VE_TEST(worldMatricesMatchTransformComponent)
+    {
+        JobSystem jobSystem{2};
+        Scene scene{};
+
+        const std::vector<TransformComponent> transforms{randomTransforms(37, 4.0F * glm::pi<float>())};
+        for(const auto& transform : transforms)
+        {
+            addObject(scene, transform);
+        }
+
+        scene.updateWorldMatrices(jobSystem);
+
+        for(std::size_t object{}; object < transforms.size(); ++object)
+        {
+            checkMatrix(scene.getWorldMatrices()[object], transforms[object].mat4());
+        }
+    }
+
+    // The range reduction must hold up for angles far outside [-pi, pi], e.g. an object spun every frame
+    VE_TEST(worldMatricesMatchForLargeAngles)
+    {
+        JobSystem jobSystem{1};
+        Scene scene{};
+
+        const std::vector<TransformComponent> transforms{randomTransforms(16, 1000.0F)};
+        for(const auto& transform : transforms)
+        {
+            addObject(scene, transform);
+        }
+
+        scene.updateWorldMatrices(jobSystem);
+
+        for(std::size_t object{}; object < transforms.size(); ++object)
+        {
+            checkMatrix(scene.getWorldMatrices()[object], transforms[object].mat4());
+        }
+    }
+
+    // Multiples of pi/2 sit right on the quadrant boundaries, where a wrong sign shows up first
+    VE_TEST(worldMatricesMatchOnQuadrantBoundaries)
+    {
+        JobSystem jobSystem{1};
+        Scene scene{};
+
+        std::vector<TransformComponent> transforms;
+        for(int quadrant{-8}; quadrant <= 8; ++quadrant)
+        {
+            const float angle{static_cast<float>(quadrant) * glm::half_pi<float>()};
+
+            TransformComponent transform{};
+            transform.rotation = {angle, -angle, angle * 0.5F};
+            transforms.push_back(transform);
+            addObject(scene, transform);
+        }
+
+        scene.updateWorldMatrices(jobSystem);
+
+        for(std::size_t object{}; object < transforms.size(); ++object)
+        {
+            checkMatrix(scene.getWorldMatrices()[object], transforms[object].mat4());
+        }
+    }
+
+    // Only the touched batch is rebuilt, the others have to keep their matrices
+    VE_TEST(changedObjectIsRebuilt)
+    {
+        JobSystem jobSystem{2};
+        Scene scene{};
+
+        std::vector<TransformComponent> transforms{randomTransforms(24, glm::pi<float>())};
+        for(const auto& transform : transforms)
+        {
+            addObject(scene, transform);
+        }
+        scene.updateWorldMatrices(jobSystem);
+
+        transforms[13].rotation = {0.5F, -1.5F, 2.5F};
+        transforms[13].translation = {1.0F, 2.0F, 3.0F};
+        scene.setRotation(13, transforms[13].rotation);
+        scene.setTranslation(13, transforms[13].translation);
+        scene.updateWorldMatrices(jobSystem);
+
+        for(std::size_t object{}; object < transforms.size(); ++object)
+        {
+            checkMatrix(scene.getWorldMatrices()[object], transforms[object].mat4());
+        }
+    }
+
+    VE_TEST(childFollowsParent)
+    {
+        JobSystem jobSystem{2};
+        Scene scene{};
+
+        const std::vector<TransformComponent> transforms{randomTransforms(3, glm::pi<float>())};
+        const Scene::ObjectId root{addObject(scene, transforms[0])};
+        const Scene::ObjectId child{addObject(scene, transforms[1], root)};
+        const Scene::ObjectId grandchild{addObject(scene, transforms[2], child)};
+
+        scene.updateWorldMatrices(jobSystem);
+
+        const glm::mat4 childWorld{transforms[0].mat4() * transforms[1].mat4()};
+        checkMatrix(scene.getWorldMatrices()[root], transforms[0].mat4());
+        checkMatrix(scene.getWorldMatrices()[child], childWorld);
+        checkMatrix(scene.getWorldMatrices()[grandchild], childWorld * transforms[2].mat4());
+
+        // Moving the root drags the whole subtree along
+        TransformComponent moved{transforms[0]};
+        moved.translation = {-5.0F, 0.0F, 5.0F};
+        scene.setTranslation(root, moved.translation);
+        scene.updateWorldMatrices(jobSystem);
+
+        checkMatrix(scene.getWorldMatrices()[grandchild], moved.mat4() * transforms[1].mat4() * transforms[2].mat4());
+    }
+
+    VE_TEST(parentCycleIsRejected)
+    {
+        Scene scene{};
+
+        const Scene::ObjectId parent{scene.createObject(nullptr)};
+        const Scene::ObjectId child{scene.createObject(nullptr, {}, glm::vec3{1.0F}, parent)};
+
+        VE_CHECK_THROWS(scene.setParent(parent, child));
+        VE_CHECK(scene.getParent(parent) == Scene::NO_PARENT);
+    }
+}
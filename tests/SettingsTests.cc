@@ -0,0 +1,97 @@
+#include "Test.h"
+
+#include "Settings.h"
+
+// std
+#include <string>
+#include <vector>
+
+namespace VE
+{
+    static Settings parse(std::vector<std::string> options)
+    {
+        options.insert(options.begin(), "VulkanEngine");
+
+        std::vector<char*> argv;
+        for(auto& option : options)
+        {
+            argv.push_back(option.data());
+        }
+
+        return Settings::fromCommandLine(static_cast<int>(argv.size()), argv.data());
+    }
+
+    VE_TEST(noOptionsGiveDefaults)
+    {
+        const Settings settings{parse({})};
+
+        VE_CHECK(settings.width == 800);
+        VE_CHECK(settings.height == 600);
+        VE_CHECK(!settings.headless);
+        VE_CHECK(!settings.benchmark);
+        VE_CHECK(settings.maxFrames == 0);
+        VE_CHECK(settings.framesInFlight == 2);
+        VE_CHECK(settings.presentMode == VK_PRESENT_MODE_FIFO_KHR);
+    }
+
+    VE_TEST(optionsAreParsed)
+    {
+        const Settings settings{parse({"--headless", "--width", "1920", "--height", "1080", "--threads", "3",
+                                       "--frames-in-flight", "1", "--present-mode", "mailbox", "--model", "a.obj",
+                                       "--model", "b.obj"})};
+
+        VE_CHECK(settings.headless);
+        VE_CHECK(settings.width == 1920);
+        VE_CHECK(settings.height == 1080);
+        VE_CHECK(settings.workerThreads == 3);
+        VE_CHECK(settings.framesInFlight == 1);
+        VE_CHECK(settings.presentMode == VK_PRESENT_MODE_MAILBOX_KHR);
+        VE_CHECK(settings.modelPaths == std::vector<std::string>({"a.obj", "b.obj"}));
+    }
+
+    VE_TEST(unknownOrIncompleteOptionsThrow)
+    {
+        VE_CHECK_THROWS(parse({"--fullscreen"}));
+        VE_CHECK_THROWS(parse({"--width"}));
+        VE_CHECK_THROWS(parse({"--present-mode", "vsync"}));
+        VE_CHECK_THROWS(parse({"--report-format", "xml"}));
+    }
+
+    VE_TEST(malformedNumbersThrow)
+    {
+        VE_CHECK_THROWS(parse({"--frames", ""}));
+        VE_CHECK_THROWS(parse({"--frames", "12x"}));
+        VE_CHECK_THROWS(parse({"--frames", "-1"}));
+        VE_CHECK_THROWS(parse({"--cubes", "99999999999999999999999"}));
+        VE_CHECK_THROWS(parse({"--width", "0"}));
+    }
+
+    // Values that don't fit the field must not wrap in the narrowing cast
+    VE_TEST(narrowedValuesAreRangeChecked)
+    {
+        VE_CHECK(parse({"--width", "2147483647"}).width == 2147483647);
+        VE_CHECK_THROWS(parse({"--width", "2147483648"}));
+        VE_CHECK_THROWS(parse({"--height", "4294967296"}));
+
+        VE_CHECK(parse({"--threads", "4294967295"}).workerThreads == 4294967295U);
+        VE_CHECK_THROWS(parse({"--threads", "4294967296"}));
+        VE_CHECK_THROWS(parse({"--frames-in-flight", "4294967297"}));
+    }
+
+    VE_TEST(benchmarkDefaults)
+    {
+        const Settings json{parse({"--benchmark"})};
+        VE_CHECK(json.maxFrames == 1000);
+        VE_CHECK(json.reportPath == "benchmark.json");
+
+        const Settings csv{parse({"--benchmark", "--report-format", "csv", "--frames", "10"})};
+        VE_CHECK(csv.maxFrames == 10);
+        VE_CHECK(csv.reportPath == "benchmark.csv");
+    }
+
+    VE_TEST(benchmarkNeedsWarmup)
+    {
+        VE_CHECK_THROWS(parse({"--benchmark", "--warmup", "0"}));
+        VE_CHECK(parse({"--warmup", "0"}).warmupFrames == 0);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// std
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace VE::Test
+{
+    // Thrown by a failed check, the runner reports it and carries on with the next test
+    struct Failure : std::runtime_error
+    {
+        using std::runtime_error::runtime_error;
+    };
+
+    using TestFunction = void (*)(void);
+
+    // Adds a test to the list TestMain.cc runs, in the order the static objects are constructed
+    struct Registrar
+    {
+        Registrar(const char* name, TestFunction function);
+    };
+
+    [[noreturn]] inline void fail(const char* file, int line, const std::string& message)
+    {
+        std::ostringstream stream;
+        stream << file << ':' << line << ": " << message;
+        throw Failure{stream.str()};
+    }
+}
+
+#define VE_TEST(name)                                                                              \
+    static void name(void);                                                                        \
+    static const VE::Test::Registrar name##Registrar{#name, name};                                 \
+    static void name(void)
+
+#define VE_CHECK(condition)                                                                        \
+    do                                                                                             \
+    {                                                                                              \
+        if(!(condition))                                                                           \
+        {                                                                                          \
+            VE::Test::fail(__FILE__, __LINE__, "check failed: " #condition);                       \
+        }                                                                                          \
+    } while(false)
+
+#define VE_CHECK_NEAR(actual, expected, tolerance)                                                 \
+    do                                                                                             \
+    {                                                                                              \
+        const double veActual{static_cast<double>(actual)};                                        \
+        const double veExpected{static_cast<double>(expected)};                                    \
+        if(!(std::abs(veActual - veExpected) <= static_cast<double>(tolerance)))                   \
+        {                                                                                          \
+            std::ostringstream veStream;                                                           \
+            veStream << #actual << " is " << veActual << ", expected " << veExpected;              \
+            VE::Test::fail(__FILE__, __LINE__, veStream.str());                                    \
+        }                                                                                          \
+    } while(false)
+
+#define VE_CHECK_THROWS(expression)                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        bool veThrew{};                                                                            \
+        try                                                                                        \
+        {                                                                                          \
+            static_cast<void>(expression);                                                         \
+        }                                                                                          \
+        catch(const std::exception&)                                                               \
+        {                                                                                          \
+            veThrew = true;                                                                        \
+        }                                                                                          \
+        if(!veThrew)                                                                               \
+        {                                                                                          \
+            VE::Test::fail(__FILE__, __LINE__, "expected an exception from " #expression);         \
+        }                                                                                          \
+    } while(false)
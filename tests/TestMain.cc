@@ -0,0 +1,46 @@
+#include "Test.h"
+
+// std
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace VE::Test
+{
+    // Function local, so registering from other translation units doesn't depend on initialization order
+    static std::vector<std::pair<const char*, TestFunction>>& tests(void)
+    {
+        static std::vector<std::pair<const char*, TestFunction>> registered;
+        return registered;
+    }
+
+    Registrar::Registrar(const char* name, TestFunction function)
+    {
+        tests().emplace_back(name, function);
+    }
+}
+
+int main(void)
+{
+    std::size_t failed{};
+
+    for(const auto& [name, function] : VE::Test::tests())
+    {
+        try
+        {
+            function();
+            std::cout << "[  OK  ] " << name << std::endl;
+        }
+        catch(const std::exception& exception)
+        {
+            ++failed;
+            std::cout << "[ FAIL ] " << name << ": " << exception.what() << std::endl;
+        }
+    }
+
+    std::cout << VE::Test::tests().size() - failed << '/' << VE::Test::tests().size() << " tests passed" << std::endl;
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}